@@ -0,0 +1,712 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * BucketStorage.h
+ *		Where GrowingGlobalPoolAllocator keeps its buckets. Pick one by passing its option to the
+ *		pool.
+ *
+ *		HeapBuckets (default)
+ *			Each bucket is a separate heap allocation and we keep a flat table of their base
+ *			pointers. Finding an element is a load of its bucket's base then shift/mask.
+ *
+ *		ReservedAddressSpace
+ *			We reserve address space for every element the pool could ever hold up front with
+ *			mmap(PROT_NONE). Creating a bucket just makes its pages accessible, and releasing it
+ *			hands the pages back to the OS with madvise(MADV_DONTNEED) while keeping the
+ *			reservation. So there is no table at all, an element is at base + index * sizeof(T).
+ *			Costs maxElements * sizeof(T) of virtual (not physical) memory.
+ *
+ *		TransparentHugePages / ExplicitHugePages
+ *			ReservedAddressSpace but backing buckets with 2MB pages, so random access across a big
+ *			pool takes far fewer dTLB misses. Each bucket is rounded up to a whole number of huge
+ *			pages, so pick a bucket size that is close to a multiple of 2MB or the tail of every
+ *			bucket is wasted (and with huge pages wasted virtual memory is wasted physical memory).
+ *			Transparent asks for them with madvise(MADV_HUGEPAGE), Explicit maps each bucket with
+ *			MAP_HUGETLB from the preallocated pool (vm.nr_hugepages). If huge pages aren't
+ *			available both quietly fall back to normal pages.
+ *
+ *		Every storage provides the same interface:
+ *			Get(index) -> MemBlock &
+ *			IsCreated(bucketNum) -> bool    (acquire, so LockFree pools can check without a lock)
+ *			Create(bucketNum, populate)     (throws std::bad_alloc if it can't. If populate is true
+ *			                                 the pages are faulted in before it is published)
+ *			Release(bucketNum)
+ *			NumOfBuckets() -> std::size_t
+ *
+ *		ReservedAddressSpace and the huge page storages can also map an address back to its index,
+ *		which is what lets PoolMemoryResource hand out plain pointers:
+ *			Contains(const void *) -> bool
+ *			IndexOf(const MemBlock *) -> index
+ *
+ *		PackedLayout pools wrap their storage in a LinkedStorage, which keeps a second storage of
+ *		free list links for the same buckets and adds
+ *			Link(index) -> the pool's IndexType &
+ *
+ *		SoaPoolAllocator's pool uses a ColumnStorage, which keeps a storage per column of the
+ *		same buckets next to the pool's own and adds
+ *			Column<column>() -> that column's storage
+ *		RefCounted pools use one too, with the reference counts as its only column. It passes
+ *		Link, Contains and IndexOf through to the storage it wraps.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "PoolOptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Assertions for testing, but have performance implications so are disabled by default.
+#ifndef HGALLOC_ASSERT
+#ifdef HGALLOC_DEBUG_ASSERTIONS
+#define HGALLOC_ASSERT(x) assert(x)
+#else
+#define HGALLOC_ASSERT(x)
+#endif
+#endif
+
+namespace hgalloc {
+
+// Writes to every page in [begin, begin + length) to fault them in now rather than on first use
+inline auto TouchPages(void *begin, std::size_t length) -> void
+{
+	// No smaller pages than this in practice, touching a bigger page more than once is harmless
+	constexpr std::size_t minPageSize(4'096);
+	auto *const bytes(static_cast<volatile char *>(begin));
+	for (std::size_t offset(0); offset < length; offset += minPageSize) { bytes[offset] = 0; }
+}
+
+template<typename MemBlock, std::size_t bucketSize>
+class HeapBucketStorage {
+public:
+	HeapBucketStorage() = default;
+	explicit HeapBucketStorage(std::size_t numOfBuckets);
+	~HeapBucketStorage();
+
+	HeapBucketStorage(HeapBucketStorage &&) noexcept;
+	HeapBucketStorage &operator=(HeapBucketStorage &&) noexcept;
+	HeapBucketStorage(const HeapBucketStorage &) = delete;
+	HeapBucketStorage &operator=(const HeapBucketStorage &) = delete;
+
+	[[nodiscard]] auto Get(std::size_t ptr) const -> MemBlock &;
+	[[nodiscard]] auto IsCreated(std::size_t bucketNum) const -> bool;
+	auto Create(std::size_t bucketNum, bool populate = false) -> void;
+	auto Release(std::size_t bucketNum) -> void;
+	[[nodiscard]] auto NumOfBuckets() const -> std::size_t;
+
+private:
+	static constexpr std::size_t BUCKET_SHIFT{std::countr_zero(bucketSize)};
+	static constexpr std::size_t BUCKET_MASK{bucketSize - 1};
+
+	std::unique_ptr<MemBlock *[]> buckets_;
+	std::size_t numOfBuckets_{0};
+};
+
+enum class PageMode {
+	Normal,
+	TransparentHuge,
+	ExplicitHuge,
+};
+
+template<typename MemBlock, std::size_t bucketSize, PageMode pageMode = PageMode::Normal>
+class ReservedAddressSpaceStorage {
+public:
+	ReservedAddressSpaceStorage() = default;
+	explicit ReservedAddressSpaceStorage(std::size_t numOfBuckets);
+	~ReservedAddressSpaceStorage();
+
+	ReservedAddressSpaceStorage(ReservedAddressSpaceStorage &&) noexcept;
+	ReservedAddressSpaceStorage &operator=(ReservedAddressSpaceStorage &&) noexcept;
+	ReservedAddressSpaceStorage(const ReservedAddressSpaceStorage &) = delete;
+	ReservedAddressSpaceStorage &operator=(const ReservedAddressSpaceStorage &) = delete;
+
+	[[nodiscard]] auto Get(std::size_t ptr) const -> MemBlock &;
+	[[nodiscard]] auto IsCreated(std::size_t bucketNum) const -> bool;
+	auto Create(std::size_t bucketNum, bool populate = false) -> void;
+	auto Release(std::size_t bucketNum) -> void;
+	[[nodiscard]] auto NumOfBuckets() const -> std::size_t;
+	[[nodiscard]] auto Contains(const void *) const -> bool;
+	[[nodiscard]] auto IndexOf(const MemBlock *) const -> std::size_t;
+
+	static constexpr std::size_t HUGE_PAGE_SIZE{std::size_t{2} * 1024 * 1024};
+
+private:
+	static constexpr std::size_t BUCKET_SHIFT{std::countr_zero(bucketSize)};
+	static constexpr std::size_t BUCKET_MASK{bucketSize - 1};
+	static constexpr std::size_t BUCKET_BYTES{bucketSize * sizeof(MemBlock)};
+	// How far apart buckets are, huge page buckets start on a huge page boundary
+	static constexpr std::size_t BUCKET_STRIDE{
+			pageMode == PageMode::Normal
+					? BUCKET_BYTES
+					: (BUCKET_BYTES + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE};
+
+	// The whole pages inside a bucket and the pages it touches at all. If buckets aren't a whole
+	// number of pages then neighbours share a page, which we never release.
+	[[nodiscard]] auto InnerPages(std::size_t bucketNum) const -> std::pair<char *, std::size_t>;
+	[[nodiscard]] auto OuterPages(std::size_t bucketNum) const -> std::pair<char *, std::size_t>;
+
+	// Replaces a bucket's mapping with MAP_HUGETLB pages, or normal pages if there aren't any
+	auto MapExplicitHugePages(std::size_t bucketNum) -> void;
+
+	char *base_{nullptr};
+	std::size_t reservedBytes_{0};
+	std::size_t pageSize_{0};
+	std::unique_ptr<bool[]> created_;
+	std::size_t numOfBuckets_{0};
+};
+
+// Elements in one storage and their free list links in another with the same buckets, which are
+// created and released together. Used by PackedLayout.
+template<typename Elements, typename Links>
+class LinkedStorage {
+public:
+	using MemBlock = std::remove_cvref_t<decltype(std::declval<Elements &>().Get(0))>;
+	using LinkBlock = std::remove_cvref_t<decltype(std::declval<Links &>().Get(0))>;
+
+	LinkedStorage() = default;
+	explicit LinkedStorage(std::size_t numOfBuckets);
+
+	[[nodiscard]] auto Get(std::size_t ptr) const -> MemBlock &;
+	[[nodiscard]] auto Link(std::size_t ptr) const -> LinkBlock &;
+	[[nodiscard]] auto IsCreated(std::size_t bucketNum) const -> bool;
+	auto Create(std::size_t bucketNum, bool populate = false) -> void;
+	auto Release(std::size_t bucketNum) -> void;
+	[[nodiscard]] auto NumOfBuckets() const -> std::size_t;
+	[[nodiscard]] auto Contains(const void *) const -> bool;
+	[[nodiscard]] auto IndexOf(const MemBlock *) const -> std::size_t;
+
+private:
+	Elements elements_;
+	Links links_;
+};
+
+// Whether ColumnStorage fills a new bucket's columns. Value zeroes them, which writes to every
+// page of every column, so columns that are always set before they are read should use Default.
+enum class ColumnInit {
+	Default,
+	Value,
+};
+
+// One storage of slots, which are what the pool allocates and hold the free list links, and one
+// storage per column with the same buckets. SoaPoolAllocator value initialises its columns so a
+// scan over them never reads indeterminate values, the pool's reference counts are set when an
+// element is shared so are left alone.
+template<std::size_t bucketSize, ColumnInit init, typename Slots, typename... Columns>
+class ColumnStorage {
+public:
+	using MemBlock = std::remove_cvref_t<decltype(std::declval<Slots &>().Get(0))>;
+
+	ColumnStorage() = default;
+	explicit ColumnStorage(std::size_t numOfBuckets);
+
+	[[nodiscard]] auto Get(std::size_t ptr) const -> MemBlock &;
+	template<std::size_t column>
+	[[nodiscard]] auto Column() const -> const auto &;
+	[[nodiscard]] auto IsCreated(std::size_t bucketNum) const -> bool;
+	auto Create(std::size_t bucketNum, bool populate = false) -> void;
+	auto Release(std::size_t bucketNum) -> void;
+	[[nodiscard]] auto NumOfBuckets() const -> std::size_t;
+	// Only compile if Slots has them
+	[[nodiscard]] auto Link(std::size_t ptr) const -> auto &;
+	[[nodiscard]] auto Contains(const void *) const -> bool;
+	[[nodiscard]] auto IndexOf(const MemBlock *) const -> std::size_t;
+
+private:
+	// Creates columns [column, end), releasing any it created if a later one throws
+	template<std::size_t column>
+	auto CreateColumns(std::size_t bucketNum, bool populate) -> void;
+
+	Slots slots_;
+	std::tuple<Columns...> columns_;
+};
+
+struct StorageOption : PoolOption {
+};
+
+// The default, see above
+struct HeapBuckets : StorageOption {
+	template<typename MemBlock, std::size_t bucketSize>
+	using Storage = HeapBucketStorage<MemBlock, bucketSize>;
+};
+
+// Reserve the whole pool's address space up front, see above
+struct ReservedAddressSpace : StorageOption {
+	template<typename MemBlock, std::size_t bucketSize>
+	using Storage = ReservedAddressSpaceStorage<MemBlock, bucketSize>;
+};
+
+// ReservedAddressSpace backed by transparent huge pages, see above
+struct TransparentHugePages : StorageOption {
+	template<typename MemBlock, std::size_t bucketSize>
+	using Storage = ReservedAddressSpaceStorage<MemBlock, bucketSize, PageMode::TransparentHuge>;
+};
+
+// ReservedAddressSpace backed by MAP_HUGETLB pages, see above
+struct ExplicitHugePages : StorageOption {
+	template<typename MemBlock, std::size_t bucketSize>
+	using Storage = ReservedAddressSpaceStorage<MemBlock, bucketSize, PageMode::ExplicitHuge>;
+};
+
+/*
+ * HeapBucketStorage
+ */
+template<typename MemBlock, std::size_t bs>
+HeapBucketStorage<MemBlock, bs>::HeapBucketStorage(std::size_t numOfBuckets)
+	: buckets_(std::make_unique<MemBlock *[]>(numOfBuckets)), numOfBuckets_(numOfBuckets)
+{
+}
+
+template<typename MemBlock, std::size_t bs>
+HeapBucketStorage<MemBlock, bs>::~HeapBucketStorage()
+{
+	for (std::size_t i(0); i < numOfBuckets_; ++i) { Release(i); }
+}
+
+template<typename MemBlock, std::size_t bs>
+HeapBucketStorage<MemBlock, bs>::HeapBucketStorage(HeapBucketStorage &&rhs) noexcept
+	: buckets_(std::move(rhs.buckets_)), numOfBuckets_(std::exchange(rhs.numOfBuckets_, 0))
+{
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::operator=(HeapBucketStorage &&rhs) noexcept
+		-> HeapBucketStorage &
+{
+	// rhs takes our buckets and frees them when it goes
+	std::swap(buckets_, rhs.buckets_);
+	std::swap(numOfBuckets_, rhs.numOfBuckets_);
+	return *this;
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::Get(std::size_t ptr) const -> MemBlock &
+{
+	const std::size_t bucketNum(ptr >> BUCKET_SHIFT);
+	const std::size_t index(ptr & BUCKET_MASK);
+	HGALLOC_ASSERT(bucketNum < numOfBuckets_ && buckets_[bucketNum] != nullptr);
+
+	return buckets_[bucketNum][index];
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::IsCreated(std::size_t bucketNum) const -> bool
+{
+	return std::atomic_ref<MemBlock *>(buckets_[bucketNum]).load(std::memory_order_acquire) !=
+		   nullptr;
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::Create(std::size_t bucketNum, bool populate) -> void
+{
+	HGALLOC_ASSERT(buckets_[bucketNum] == nullptr);
+	// Deliberately not value initialised, pages are only faulted in as elements are first used
+	auto *bucket(new MemBlock[bs]);
+	if (populate) { TouchPages(bucket, bs * sizeof(MemBlock)); }
+	std::atomic_ref<MemBlock *>(buckets_[bucketNum]).store(bucket, std::memory_order_release);
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::Release(std::size_t bucketNum) -> void
+{
+	delete[] std::exchange(buckets_[bucketNum], nullptr);
+}
+
+template<typename MemBlock, std::size_t bs>
+auto HeapBucketStorage<MemBlock, bs>::NumOfBuckets() const -> std::size_t
+{
+	return numOfBuckets_;
+}
+
+/*
+ * ReservedAddressSpaceStorage
+ */
+template<typename MemBlock, std::size_t bs, PageMode pm>
+ReservedAddressSpaceStorage<MemBlock, bs, pm>::ReservedAddressSpaceStorage(
+		std::size_t numOfBuckets)
+	: pageSize_(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+	  created_(std::make_unique<bool[]>(numOfBuckets)), numOfBuckets_(numOfBuckets)
+{
+	reservedBytes_ = numOfBuckets * BUCKET_STRIDE;
+	if (reservedBytes_ == 0) { return; }
+
+	// Huge pages have to start on a huge page boundary, so over reserve then trim to line up
+	const std::size_t alignment(pm == PageMode::Normal ? pageSize_ : HUGE_PAGE_SIZE);
+	const std::size_t mappedBytes(reservedBytes_ + alignment - pageSize_);
+
+	// MAP_NORESERVE as we don't want to be charged for memory until we make it accessible
+	void *mapped(mmap(nullptr, mappedBytes, PROT_NONE,
+					  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+	if (mapped == MAP_FAILED) { throw std::bad_alloc(); }
+
+	auto *const begin(static_cast<char *>(mapped));
+	base_ = reinterpret_cast<char *>(
+			(reinterpret_cast<std::uintptr_t>(begin) + alignment - 1) / alignment * alignment);
+	if (base_ != begin) { munmap(begin, static_cast<std::size_t>(base_ - begin)); }
+	const std::size_t tail(
+			static_cast<std::size_t>(begin + mappedBytes - (base_ + reservedBytes_)));
+	if (tail != 0) { munmap(base_ + reservedBytes_, tail); }
+
+	if constexpr (pm == PageMode::TransparentHuge) {
+		// Fails if THP is disabled, in which case we just get normal pages
+		madvise(base_, reservedBytes_, MADV_HUGEPAGE);
+	}
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+ReservedAddressSpaceStorage<MemBlock, bs, pm>::~ReservedAddressSpaceStorage()
+{
+	if (base_ != nullptr) { munmap(base_, reservedBytes_); }
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+ReservedAddressSpaceStorage<MemBlock, bs, pm>::ReservedAddressSpaceStorage(
+		ReservedAddressSpaceStorage &&rhs) noexcept
+	: base_(std::exchange(rhs.base_, nullptr)),
+	  reservedBytes_(std::exchange(rhs.reservedBytes_, 0)), pageSize_(rhs.pageSize_),
+	  created_(std::move(rhs.created_)), numOfBuckets_(std::exchange(rhs.numOfBuckets_, 0))
+{
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::operator=(
+		ReservedAddressSpaceStorage &&rhs) noexcept -> ReservedAddressSpaceStorage &
+{
+	// rhs takes our reservation and unmaps it when it goes
+	std::swap(base_, rhs.base_);
+	std::swap(reservedBytes_, rhs.reservedBytes_);
+	std::swap(pageSize_, rhs.pageSize_);
+	std::swap(created_, rhs.created_);
+	std::swap(numOfBuckets_, rhs.numOfBuckets_);
+	return *this;
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::Get(std::size_t ptr) const -> MemBlock &
+{
+	HGALLOC_ASSERT(IsCreated(ptr >> BUCKET_SHIFT));
+	if constexpr (BUCKET_STRIDE == BUCKET_BYTES) {
+		return reinterpret_cast<MemBlock *>(base_)[ptr];
+	} else {
+		auto *const bucket(base_ + (ptr >> BUCKET_SHIFT) * BUCKET_STRIDE);
+		return reinterpret_cast<MemBlock *>(bucket)[ptr & BUCKET_MASK];
+	}
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::Contains(const void *ptr) const -> bool
+{
+	// Compare as integers, comparing pointers to different objects isn't defined
+	const auto address(reinterpret_cast<std::uintptr_t>(ptr));
+	const auto base(reinterpret_cast<std::uintptr_t>(base_));
+	return address >= base && address < base + numOfBuckets_ * BUCKET_STRIDE;
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::IndexOf(const MemBlock *block) const
+		-> std::size_t
+{
+	HGALLOC_ASSERT(Contains(block));
+	const std::size_t offset(reinterpret_cast<std::uintptr_t>(block) -
+							 reinterpret_cast<std::uintptr_t>(base_));
+	// Both divisions are by constants, so they compile to multiplies
+	if constexpr (BUCKET_STRIDE == BUCKET_BYTES) {
+		return offset / sizeof(MemBlock);
+	} else {
+		const std::size_t bucketNum(offset / BUCKET_STRIDE);
+		const std::size_t index((offset % BUCKET_STRIDE) / sizeof(MemBlock));
+		return (bucketNum << BUCKET_SHIFT) + index;
+	}
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::IsCreated(std::size_t bucketNum) const -> bool
+{
+	return std::atomic_ref<bool>(created_[bucketNum]).load(std::memory_order_acquire);
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::Create(std::size_t bucketNum, bool populate)
+		-> void
+{
+	HGALLOC_ASSERT(!created_[bucketNum]);
+
+	if constexpr (pm == PageMode::ExplicitHuge) {
+		MapExplicitHugePages(bucketNum);
+	} else {
+		// Pages are faulted in as elements are first used
+		const auto [pages, length](OuterPages(bucketNum));
+		if (mprotect(pages, length, PROT_READ | PROT_WRITE) != 0) { throw std::bad_alloc(); }
+	}
+
+	if (populate) {
+		// Doesn't change the contents, so it's fine that we may share a page with our neighbours
+		const auto [pages, length](OuterPages(bucketNum));
+#ifdef MADV_POPULATE_WRITE
+		// One syscall rather than a fault per page, needs Linux 5.14
+		if (madvise(pages, length, MADV_POPULATE_WRITE) != 0) {
+			TouchPages(base_ + bucketNum * BUCKET_STRIDE, BUCKET_BYTES);
+		}
+#else
+		TouchPages(base_ + bucketNum * BUCKET_STRIDE, BUCKET_BYTES);
+#endif
+	}
+
+	std::atomic_ref<bool>(created_[bucketNum]).store(true, std::memory_order_release);
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::Release(std::size_t bucketNum) -> void
+{
+	created_[bucketNum] = false;
+
+	const auto [pages, length](InnerPages(bucketNum));
+	if (length == 0) { return; }
+
+	if constexpr (pm == PageMode::ExplicitHuge) {
+		// Put back the reservation we started with, which hands the huge pages back to the pool
+		mmap(pages, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+			 -1, 0);
+	} else {
+		// Gives the memory back but keeps the address space, and protecting it again means a use
+		// after free crashes rather than silently reading zeros.
+		madvise(pages, length, MADV_DONTNEED);
+		mprotect(pages, length, PROT_NONE);
+	}
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::NumOfBuckets() const -> std::size_t
+{
+	return numOfBuckets_;
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::InnerPages(std::size_t bucketNum) const
+		-> std::pair<char *, std::size_t>
+{
+	const std::size_t begin(bucketNum * BUCKET_STRIDE);
+	const std::size_t end(begin + BUCKET_STRIDE);
+
+	const std::size_t firstPage((begin + pageSize_ - 1) / pageSize_ * pageSize_);
+	const std::size_t lastPage(end / pageSize_ * pageSize_);
+	if (lastPage <= firstPage) { return {base_ + firstPage, 0}; }
+
+	return {base_ + firstPage, lastPage - firstPage};
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::OuterPages(std::size_t bucketNum) const
+		-> std::pair<char *, std::size_t>
+{
+	const std::size_t begin(bucketNum * BUCKET_STRIDE);
+	const std::size_t end(std::min(begin + BUCKET_STRIDE, reservedBytes_));
+
+	const std::size_t firstPage(begin / pageSize_ * pageSize_);
+	const std::size_t lastPage((end + pageSize_ - 1) / pageSize_ * pageSize_);
+
+	return {base_ + firstPage, lastPage - firstPage};
+}
+
+template<typename MemBlock, std::size_t bs, PageMode pm>
+auto ReservedAddressSpaceStorage<MemBlock, bs, pm>::MapExplicitHugePages(std::size_t bucketNum)
+		-> void
+{
+	auto *const bucket(base_ + bucketNum * BUCKET_STRIDE);
+	constexpr int fixed(MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED);
+
+#ifdef MAP_HUGE_2MB
+	constexpr int hugeFlags(MAP_HUGETLB | MAP_HUGE_2MB);
+#else
+	constexpr int hugeFlags(MAP_HUGETLB);
+#endif
+
+	// Without MAP_NORESERVE the huge pages are reserved now, so if the pool has run out we find out
+	// here rather than with a SIGBUS when we first touch them.
+	if (mmap(bucket, BUCKET_STRIDE, PROT_READ | PROT_WRITE, fixed | hugeFlags, -1, 0) !=
+		MAP_FAILED) {
+		return;
+	}
+
+	// Fall back to normal pages. A failed MAP_FIXED may or may not have unmapped our reservation,
+	// and if it did we mustn't clobber anything another thread has mapped there since.
+	if (mprotect(bucket, BUCKET_STRIDE, PROT_READ | PROT_WRITE) == 0) { return; }
+	if (mmap(bucket, BUCKET_STRIDE, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != bucket) {
+		throw std::bad_alloc();
+	}
+}
+
+/*
+ * LinkedStorage
+ */
+template<typename Elements, typename Links>
+LinkedStorage<Elements, Links>::LinkedStorage(std::size_t numOfBuckets)
+	: elements_(numOfBuckets), links_(numOfBuckets)
+{
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::Get(std::size_t ptr) const -> MemBlock &
+{
+	return elements_.Get(ptr);
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::Link(std::size_t ptr) const -> LinkBlock &
+{
+	return links_.Get(ptr);
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::IsCreated(std::size_t bucketNum) const -> bool
+{
+	// Published last by Create, so the links are there too
+	return elements_.IsCreated(bucketNum);
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::Create(std::size_t bucketNum, bool populate) -> void
+{
+	links_.Create(bucketNum, populate);
+	try {
+		elements_.Create(bucketNum, populate);
+	} catch (...) {
+		links_.Release(bucketNum);
+		throw;
+	}
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::Release(std::size_t bucketNum) -> void
+{
+	elements_.Release(bucketNum);
+	links_.Release(bucketNum);
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::NumOfBuckets() const -> std::size_t
+{
+	return elements_.NumOfBuckets();
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::Contains(const void *ptr) const -> bool
+{
+	return elements_.Contains(ptr);
+}
+
+template<typename Elements, typename Links>
+auto LinkedStorage<Elements, Links>::IndexOf(const MemBlock *block) const -> std::size_t
+{
+	return elements_.IndexOf(block);
+}
+
+/*
+ * ColumnStorage
+ */
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+ColumnStorage<bs, init, Slots, Columns...>::ColumnStorage(std::size_t numOfBuckets)
+	: slots_(numOfBuckets), columns_(Columns(numOfBuckets)...)
+{
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::Get(std::size_t ptr) const -> MemBlock &
+{
+	return slots_.Get(ptr);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+template<std::size_t column>
+auto ColumnStorage<bs, init, Slots, Columns...>::Column() const -> const auto &
+{
+	return std::get<column>(columns_);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::IsCreated(std::size_t bucketNum) const -> bool
+{
+	// Published last by Create, so the columns are there too
+	return slots_.IsCreated(bucketNum);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::Create(std::size_t bucketNum, bool populate)
+		-> void
+{
+	CreateColumns<0>(bucketNum, populate);
+	try {
+		slots_.Create(bucketNum, populate);
+	} catch (...) {
+		std::apply([bucketNum](auto &...columns) { (columns.Release(bucketNum), ...); }, columns_);
+		throw;
+	}
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+template<std::size_t column>
+auto ColumnStorage<bs, init, Slots, Columns...>::CreateColumns(std::size_t bucketNum, bool populate)
+		-> void
+{
+	if constexpr (column < sizeof...(Columns)) {
+		auto &storage(std::get<column>(columns_));
+		storage.Create(bucketNum, populate);
+		if constexpr (init == ColumnInit::Value) {
+			std::uninitialized_value_construct_n(&storage.Get(bucketNum * bs), bs);
+		} else {
+			std::uninitialized_default_construct_n(&storage.Get(bucketNum * bs), bs);
+		}
+		try {
+			CreateColumns<column + 1>(bucketNum, populate);
+		} catch (...) {
+			storage.Release(bucketNum);
+			throw;
+		}
+	}
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::Release(std::size_t bucketNum) -> void
+{
+	slots_.Release(bucketNum);
+	std::apply([bucketNum](auto &...columns) { (columns.Release(bucketNum), ...); }, columns_);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::NumOfBuckets() const -> std::size_t
+{
+	return slots_.NumOfBuckets();
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::Link(std::size_t ptr) const -> auto &
+{
+	return slots_.Link(ptr);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::Contains(const void *ptr) const -> bool
+{
+	return slots_.Contains(ptr);
+}
+
+template<std::size_t bs, ColumnInit init, typename Slots, typename... Columns>
+auto ColumnStorage<bs, init, Slots, Columns...>::IndexOf(const MemBlock *block) const -> std::size_t
+{
+	return slots_.IndexOf(block);
+}
+
+}// namespace hgalloc
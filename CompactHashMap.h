@@ -0,0 +1,402 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * CompactHashMap.h
+ *		A chained hash map whose nodes live in a GrowingGlobalPoolAllocator and link to each other,
+ *		and are found from the table, by their 4 byte indices. A node is the key, value and a 4
+ *		byte next link, against std::unordered_map's 8 byte next pointer, cached hash and heap
+ *		header, and the table is half the size. e.g.
+ *
+ *			using Map = CompactHashMap<std::uint64_t, Order, 16'384>;
+ *			Map::Pool pool{1'000'000};
+ *			Map orders{pool};
+ *
+ *		The table doubles when there are more elements than slots. Hashes aren't stored so
+ *		growing it rehashes every key, reserve() if you know the size. Any number of maps can
+ *		share a pool, and the pool must outlive them. Inserting into a full pool throws
+ *		bad_alloc. Not thread safe, even if the pool is.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace hgalloc {
+
+template<typename Key, typename Value, std::size_t bucketSize, typename Hash = std::hash<Key>,
+		 typename KeyEqual = std::equal_to<Key>, typename... Options>
+class CompactHashMap {
+public:
+	using value_type = std::pair<const Key, Value>;
+
+	struct Node {
+		template<typename K, typename... Args>
+		explicit Node(K &&key, Args &&...args)
+			: value_(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+					 std::forward_as_tuple(std::forward<Args>(args)...))
+		{
+		}
+
+		// Lets next_ go in the pair's tail padding, e.g. after a 4 byte value with an 8 byte key
+		[[no_unique_address]] value_type value_;
+		FourBytePtr next_{NULL_PTR};
+	};
+
+	using Pool = GrowingGlobalPoolAllocator<Node, bucketSize, Options...>;
+	static constexpr FourBytePtr NULL_PTR{Pool::PtrType::NULL_PTR};
+
+	// Forward only, walks the table slot by slot and each slot's chain
+	template<bool isConst>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = CompactHashMap::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<isConst, const value_type *, value_type *>;
+		using reference = std::conditional_t<isConst, const value_type &, value_type &>;
+
+		Iterator() = default;
+		template<bool wasConst>
+		requires(isConst && !wasConst)
+		// NOLINTNEXTLINE(google-explicit-constructor) - iterator to const_iterator
+		Iterator(const Iterator<wasConst> &rhs)
+			: map_(rhs.map_), slot_(rhs.slot_), node_(rhs.node_)
+		{
+		}
+
+		auto operator*() const -> reference { return GetNode(node_).value_; }
+		auto operator->() const -> pointer { return &GetNode(node_).value_; }
+
+		auto operator++() -> Iterator &
+		{
+			node_ = GetNode(node_).next_;
+			if (node_ == NULL_PTR) { SkipEmptySlots(++slot_); }
+			return *this;
+		}
+		auto operator++(int) -> Iterator
+		{
+			const Iterator ret(*this);
+			++*this;
+			return ret;
+		}
+
+		friend auto operator==(const Iterator &lhs, const Iterator &rhs) -> bool
+		{
+			return lhs.node_ == rhs.node_;
+		}
+
+	private:
+		friend CompactHashMap;
+		friend Iterator<!isConst>;
+
+		Iterator(const CompactHashMap *map, std::size_t slot, FourBytePtr node)
+			: map_(map), slot_(slot), node_(node)
+		{
+		}
+
+		// Moves to the first node at or after slot, or end() if there isn't one
+		auto SkipEmptySlots(std::size_t slot) -> void
+		{
+			const auto &table(map_->table_);
+			while (slot < table.size() && table[slot] == NULL_PTR) { ++slot; }
+			slot_ = slot;
+			node_ = slot < table.size() ? table[slot] : NULL_PTR;
+		}
+
+		const CompactHashMap *map_{nullptr};
+		std::size_t slot_{0};
+		FourBytePtr node_{NULL_PTR};
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	explicit CompactHashMap(Pool &pool);
+	~CompactHashMap();
+
+	CompactHashMap(CompactHashMap &&) noexcept;
+	CompactHashMap &operator=(CompactHashMap &&) noexcept;
+	CompactHashMap(const CompactHashMap &) = delete;
+	CompactHashMap &operator=(const CompactHashMap &) = delete;
+
+	// Only constructs a value if the key isn't already there
+	template<typename... Args>
+	auto try_emplace(const Key &key, Args &&...args) -> std::pair<iterator, bool>;
+	auto insert(value_type value) -> std::pair<iterator, bool>;
+	auto operator[](const Key &key) -> Value &;
+
+	[[nodiscard]] auto find(const Key &key) -> iterator;
+	[[nodiscard]] auto find(const Key &key) const -> const_iterator;
+	[[nodiscard]] auto contains(const Key &key) const -> bool;
+
+	auto erase(const Key &key) -> std::size_t;
+	auto erase(const_iterator pos) -> iterator;
+	auto clear() -> void;
+
+	// Grows the table so it holds count elements without growing again
+	auto reserve(std::size_t count) -> void;
+
+	[[nodiscard]] auto begin() -> iterator;
+	[[nodiscard]] auto begin() const -> const_iterator;
+	[[nodiscard]] auto end() -> iterator;
+	[[nodiscard]] auto end() const -> const_iterator;
+
+	[[nodiscard]] auto size() const -> std::size_t;
+	[[nodiscard]] auto empty() const -> bool;
+	[[nodiscard]] auto bucket_count() const -> std::size_t;
+
+private:
+	static constexpr std::size_t MIN_TABLE_SIZE{8};
+
+	static auto GetNode(FourBytePtr ptr) -> Node &;
+	[[nodiscard]] auto SlotOf(const Key &key) const -> std::size_t;
+	// The slot and node the key is in, node is NULL_PTR if it isn't
+	[[nodiscard]] auto Find(const Key &key) const -> std::pair<std::size_t, FourBytePtr>;
+	auto Rehash(std::size_t tableSize) -> void;
+
+	Pool *pool_;
+	// The head of each slot's chain, always a power of 2 long (or empty before the first insert)
+	std::vector<FourBytePtr> table_;
+	std::size_t size_{0};
+	[[no_unique_address]] Hash hash_;
+	[[no_unique_address]] KeyEqual equal_;
+};
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+CompactHashMap<K, V, bs, H, E, Os...>::CompactHashMap(Pool &pool) : pool_(&pool)
+{
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+CompactHashMap<K, V, bs, H, E, Os...>::~CompactHashMap()
+{
+	clear();
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+CompactHashMap<K, V, bs, H, E, Os...>::CompactHashMap(CompactHashMap &&rhs) noexcept
+	: pool_(rhs.pool_), table_(std::move(rhs.table_)), size_(std::exchange(rhs.size_, 0)),
+	  hash_(std::move(rhs.hash_)), equal_(std::move(rhs.equal_))
+{
+	rhs.table_.clear();
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::operator=(CompactHashMap &&rhs) noexcept
+		-> CompactHashMap &
+{
+	if (this != &rhs) {
+		clear();
+		pool_ = rhs.pool_;
+		table_ = std::move(rhs.table_);
+		rhs.table_.clear();
+		size_ = std::exchange(rhs.size_, 0);
+		hash_ = std::move(rhs.hash_);
+		equal_ = std::move(rhs.equal_);
+	}
+	return *this;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::GetNode(FourBytePtr ptr) -> Node &
+{
+	return *Pool::AddressOf(ptr);
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::SlotOf(const K &key) const -> std::size_t
+{
+	return hash_(key) & (table_.size() - 1);
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::Find(const K &key) const
+		-> std::pair<std::size_t, FourBytePtr>
+{
+	if (table_.empty()) { return {0, NULL_PTR}; }
+
+	const std::size_t slot(SlotOf(key));
+	FourBytePtr ptr(table_[slot]);
+	while (ptr != NULL_PTR) {
+		const Node &node(GetNode(ptr));
+		if (equal_(node.value_.first, key)) { break; }
+		ptr = node.next_;
+	}
+	return {slot, ptr};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+template<typename... Args>
+auto CompactHashMap<K, V, bs, H, E, Os...>::try_emplace(const K &key, Args &&...args)
+		-> std::pair<iterator, bool>
+{
+	auto [slot, existing](Find(key));
+	if (existing != NULL_PTR) { return {iterator{this, slot, existing}, false}; }
+
+	// Before allocating, so a throw leaves nothing to clean up
+	if (size_ + 1 > table_.size()) {
+		Rehash(std::max(MIN_TABLE_SIZE, table_.size() * 2));
+		slot = SlotOf(key);
+	}
+
+	auto handle(pool_->Allocate(key, std::forward<Args>(args)...));
+	if (nullptr == handle) { throw std::bad_alloc(); }
+	// The map owns the node from here, erase() gives it back to the pool
+	const FourBytePtr ptr(handle.release());
+	GetNode(ptr).next_ = table_[slot];
+	table_[slot] = ptr;
+	++size_;
+	return {iterator{this, slot, ptr}, true};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::insert(value_type value) -> std::pair<iterator, bool>
+{
+	return try_emplace(value.first, std::move(value.second));
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::operator[](const K &key) -> V &
+{
+	return try_emplace(key).first->second;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::find(const K &key) -> iterator
+{
+	const auto [slot, ptr](Find(key));
+	return iterator{this, slot, ptr};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::find(const K &key) const -> const_iterator
+{
+	const auto [slot, ptr](Find(key));
+	return const_iterator{this, slot, ptr};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::contains(const K &key) const -> bool
+{
+	return Find(key).second != NULL_PTR;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::erase(const K &key) -> std::size_t
+{
+	const auto pos(find(key));
+	if (pos == end()) { return 0; }
+	erase(pos);
+	return 1;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::erase(const_iterator pos) -> iterator
+{
+	HGALLOC_ASSERT(pos.node_ != NULL_PTR);
+	iterator next{this, pos.slot_, pos.node_};
+	++next;
+
+	// Singly linked, so find whatever points at it
+	FourBytePtr *link(&table_[pos.slot_]);
+	while (*link != pos.node_) { link = &GetNode(*link).next_; }
+	*link = GetNode(pos.node_).next_;
+	--size_;
+
+	Pool::FreeIndex(pos.node_);
+	return next;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::clear() -> void
+{
+	for (auto &head : table_) {
+		while (head != NULL_PTR) {
+			const FourBytePtr next(GetNode(head).next_);
+			Pool::FreeIndex(head);
+			head = next;
+		}
+	}
+	size_ = 0;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::reserve(std::size_t count) -> void
+{
+	if (count > table_.size()) { Rehash(std::max(MIN_TABLE_SIZE, std::bit_ceil(count))); }
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::Rehash(std::size_t tableSize) -> void
+{
+	std::vector<FourBytePtr> oldTable(tableSize, NULL_PTR);
+	oldTable.swap(table_);
+	for (FourBytePtr head : oldTable) {
+		while (head != NULL_PTR) {
+			Node &node(GetNode(head));
+			const FourBytePtr next(node.next_);
+			const std::size_t slot(SlotOf(node.value_.first));
+			node.next_ = table_[slot];
+			table_[slot] = head;
+			head = next;
+		}
+	}
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::begin() -> iterator
+{
+	iterator it{this, 0, NULL_PTR};
+	it.SkipEmptySlots(0);
+	return it;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::begin() const -> const_iterator
+{
+	const_iterator it{this, 0, NULL_PTR};
+	it.SkipEmptySlots(0);
+	return it;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::end() -> iterator
+{
+	return iterator{this, table_.size(), NULL_PTR};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::end() const -> const_iterator
+{
+	return const_iterator{this, table_.size(), NULL_PTR};
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::size() const -> std::size_t
+{
+	return size_;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::empty() const -> bool
+{
+	return size_ == 0;
+}
+
+template<typename K, typename V, std::size_t bs, typename H, typename E, typename... Os>
+auto CompactHashMap<K, V, bs, H, E, Os...>::bucket_count() const -> std::size_t
+{
+	return table_.size();
+}
+
+}// namespace hgalloc
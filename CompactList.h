@@ -0,0 +1,338 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * CompactList.h
+ *		A doubly linked list whose nodes live in a GrowingGlobalPoolAllocator and link to each other
+ *		by their 4 byte indices, so each node is its value plus 8 bytes rather than the 16 bytes
+ *		of pointers and a heap header std::list has. e.g.
+ *
+ *			using List = CompactList<Order, 16'384>;
+ *			List::Pool pool{1'000'000};
+ *			List orders{pool};
+ *
+ *		Any number of lists can share a pool, and the pool must outlive them. Inserting into a
+ *		full pool throws bad_alloc. Not thread safe, even if the pool is.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+
+namespace hgalloc {
+
+template<typename T, std::size_t bucketSize, typename... Options>
+class CompactList {
+public:
+	struct Node {
+		template<typename... Args>
+		explicit Node(Args &&...args) : value_(std::forward<Args>(args)...)
+		{
+		}
+
+		T value_;
+		FourBytePtr prev_;
+		FourBytePtr next_;
+	};
+
+	using Pool = GrowingGlobalPoolAllocator<Node, bucketSize, Options...>;
+	static constexpr FourBytePtr NULL_PTR{Pool::PtrType::NULL_PTR};
+
+	template<bool isConst>
+	class Iterator {
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<isConst, const T *, T *>;
+		using reference = std::conditional_t<isConst, const T &, T &>;
+
+		Iterator() = default;
+		template<bool wasConst>
+		requires(isConst && !wasConst)
+		// NOLINTNEXTLINE(google-explicit-constructor) - iterator to const_iterator
+		Iterator(const Iterator<wasConst> &rhs) : list_(rhs.list_), node_(rhs.node_)
+		{
+		}
+
+		auto operator*() const -> reference { return GetNode(node_).value_; }
+		auto operator->() const -> pointer { return &GetNode(node_).value_; }
+
+		auto operator++() -> Iterator &
+		{
+			node_ = GetNode(node_).next_;
+			return *this;
+		}
+		auto operator++(int) -> Iterator
+		{
+			const Iterator ret(*this);
+			++*this;
+			return ret;
+		}
+		// end() goes back to the tail
+		auto operator--() -> Iterator &
+		{
+			node_ = node_ == NULL_PTR ? list_->tail_ : GetNode(node_).prev_;
+			return *this;
+		}
+		auto operator--(int) -> Iterator
+		{
+			const Iterator ret(*this);
+			--*this;
+			return ret;
+		}
+
+		friend auto operator==(const Iterator &lhs, const Iterator &rhs) -> bool
+		{
+			return lhs.node_ == rhs.node_;
+		}
+
+	private:
+		friend CompactList;
+		friend Iterator<!isConst>;
+
+		Iterator(const CompactList *list, FourBytePtr node) : list_(list), node_(node) {}
+
+		const CompactList *list_{nullptr};
+		FourBytePtr node_{NULL_PTR};
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	explicit CompactList(Pool &pool);
+	~CompactList();
+
+	CompactList(CompactList &&) noexcept;
+	CompactList &operator=(CompactList &&) noexcept;
+	CompactList(const CompactList &) = delete;
+	CompactList &operator=(const CompactList &) = delete;
+
+	template<typename... Args>
+	auto emplace(const_iterator pos, Args &&...args) -> iterator;
+	template<typename... Args>
+	auto emplace_front(Args &&...args) -> T &;
+	template<typename... Args>
+	auto emplace_back(Args &&...args) -> T &;
+	auto push_front(T value) -> void;
+	auto push_back(T value) -> void;
+
+	auto erase(const_iterator pos) -> iterator;
+	auto pop_front() -> void;
+	auto pop_back() -> void;
+	auto clear() -> void;
+
+	[[nodiscard]] auto front() -> T &;
+	[[nodiscard]] auto front() const -> const T &;
+	[[nodiscard]] auto back() -> T &;
+	[[nodiscard]] auto back() const -> const T &;
+
+	[[nodiscard]] auto begin() -> iterator;
+	[[nodiscard]] auto begin() const -> const_iterator;
+	[[nodiscard]] auto end() -> iterator;
+	[[nodiscard]] auto end() const -> const_iterator;
+
+	[[nodiscard]] auto size() const -> std::size_t;
+	[[nodiscard]] auto empty() const -> bool;
+
+private:
+	static auto GetNode(FourBytePtr ptr) -> Node &;
+
+	Pool *pool_;
+	FourBytePtr head_{NULL_PTR};
+	FourBytePtr tail_{NULL_PTR};
+	std::size_t size_{0};
+};
+
+template<typename T, std::size_t bs, typename... Os>
+CompactList<T, bs, Os...>::CompactList(Pool &pool) : pool_(&pool)
+{
+}
+
+template<typename T, std::size_t bs, typename... Os>
+CompactList<T, bs, Os...>::~CompactList()
+{
+	clear();
+}
+
+template<typename T, std::size_t bs, typename... Os>
+CompactList<T, bs, Os...>::CompactList(CompactList &&rhs) noexcept
+	: pool_(rhs.pool_), head_(rhs.head_), tail_(rhs.tail_), size_(rhs.size_)
+{
+	rhs.head_ = NULL_PTR;
+	rhs.tail_ = NULL_PTR;
+	rhs.size_ = 0;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::operator=(CompactList &&rhs) noexcept -> CompactList &
+{
+	if (this != &rhs) {
+		clear();
+		pool_ = rhs.pool_;
+		head_ = std::exchange(rhs.head_, NULL_PTR);
+		tail_ = std::exchange(rhs.tail_, NULL_PTR);
+		size_ = std::exchange(rhs.size_, 0);
+	}
+	return *this;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::GetNode(FourBytePtr ptr) -> Node &
+{
+	return *Pool::AddressOf(ptr);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename... Args>
+auto CompactList<T, bs, Os...>::emplace(const_iterator pos, Args &&...args) -> iterator
+{
+	auto handle(pool_->Allocate(std::forward<Args>(args)...));
+	if (nullptr == handle) { throw std::bad_alloc(); }
+	// The list owns the node from here, erase() gives it back to the pool
+	const FourBytePtr ptr(handle.release());
+	Node &node(GetNode(ptr));
+
+	const FourBytePtr next(pos.node_);
+	const FourBytePtr prev(next == NULL_PTR ? tail_ : GetNode(next).prev_);
+	node.prev_ = prev;
+	node.next_ = next;
+	(prev == NULL_PTR ? head_ : GetNode(prev).next_) = ptr;
+	(next == NULL_PTR ? tail_ : GetNode(next).prev_) = ptr;
+	++size_;
+	return iterator{this, ptr};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename... Args>
+auto CompactList<T, bs, Os...>::emplace_front(Args &&...args) -> T &
+{
+	return *emplace(begin(), std::forward<Args>(args)...);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename... Args>
+auto CompactList<T, bs, Os...>::emplace_back(Args &&...args) -> T &
+{
+	return *emplace(end(), std::forward<Args>(args)...);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::push_front(T value) -> void
+{
+	emplace_front(std::move(value));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::push_back(T value) -> void
+{
+	emplace_back(std::move(value));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::erase(const_iterator pos) -> iterator
+{
+	HGALLOC_ASSERT(pos.node_ != NULL_PTR);
+	const Node &node(GetNode(pos.node_));
+	const FourBytePtr prev(node.prev_);
+	const FourBytePtr next(node.next_);
+	(prev == NULL_PTR ? head_ : GetNode(prev).next_) = next;
+	(next == NULL_PTR ? tail_ : GetNode(next).prev_) = prev;
+	--size_;
+
+	Pool::FreeIndex(pos.node_);
+	return iterator{this, next};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::pop_front() -> void
+{
+	erase(begin());
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::pop_back() -> void
+{
+	erase(const_iterator{this, tail_});
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::clear() -> void
+{
+	FourBytePtr ptr(head_);
+	while (ptr != NULL_PTR) {
+		const FourBytePtr next(GetNode(ptr).next_);
+		Pool::FreeIndex(ptr);
+		ptr = next;
+	}
+	head_ = NULL_PTR;
+	tail_ = NULL_PTR;
+	size_ = 0;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::front() -> T &
+{
+	return GetNode(head_).value_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::front() const -> const T &
+{
+	return GetNode(head_).value_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::back() -> T &
+{
+	return GetNode(tail_).value_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::back() const -> const T &
+{
+	return GetNode(tail_).value_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::begin() -> iterator
+{
+	return iterator{this, head_};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::begin() const -> const_iterator
+{
+	return const_iterator{this, head_};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::end() -> iterator
+{
+	return iterator{this, NULL_PTR};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::end() const -> const_iterator
+{
+	return const_iterator{this, NULL_PTR};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::size() const -> std::size_t
+{
+	return size_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto CompactList<T, bs, Os...>::empty() const -> bool
+{
+	return size_ == 0;
+}
+
+}// namespace hgalloc
@@ -4,6 +4,8 @@
  *		Written for the pool allocators, we have our own FourByteScopedPtr instead of say unique_ptr as 
  *		we only need 4 bytes instead of the 8 bytes for ptr + 8 bytes for free function ptr. 
  *		Otherwise as far as the user is concerned should function exactly the same.
+ *
+ *		The index is 4 bytes unless the pool is given a different HandleType, hence the name.
  * 
  *
  *--------------------------------------------------------------------------------------------------
@@ -18,10 +20,10 @@ namespace hgalloc {
 
 using FourBytePtr = std::uint32_t;
 
-template<typename Allocator>
+template<typename Allocator, typename IndexType = FourBytePtr>
 class FourByteScopedPtr {
 public:
-	explicit FourByteScopedPtr(FourBytePtr);
+	explicit FourByteScopedPtr(IndexType);
 	static auto CreateNullPtr() -> FourByteScopedPtr;
 	~FourByteScopedPtr();
 
@@ -33,6 +35,10 @@ public:
 	auto operator->() -> Type *;
 	auto operator->() const -> const Type *;
 	auto reset() -> void;
+	// Gives up ownership without freeing, the allocator's Reclaim takes it back
+	auto release() -> IndexType;
+	// The index the handle owns, NULL_PTR if it's null
+	[[nodiscard]] auto Index() const -> IndexType;
 	auto get() -> Type *;
 	[[nodiscard]] auto get() const -> const Type *;
 
@@ -44,59 +50,62 @@ public:
 	FourByteScopedPtr(const FourByteScopedPtr &) = delete;
 	FourByteScopedPtr &operator=(const FourByteScopedPtr &) = delete;
 
-	static constexpr std::uint32_t NULL_PTR{std::numeric_limits<std::uint32_t>::max()};
-	static constexpr std::uint32_t MAX_PTR{NULL_PTR - 1};
+	static constexpr IndexType NULL_PTR{std::numeric_limits<IndexType>::max()};
+	static constexpr IndexType MAX_PTR{NULL_PTR - 1};
 
-	template<typename U>
+	template<typename U, typename I>
 	//NOLINTNEXTLINE(readability-redundant-declaration) - https://github.com/cms-sw/cmssw/issues/20318
-	friend bool operator==(const std::nullptr_t &, const FourByteScopedPtr<U> &rhs);
-	template<typename U>
+	friend bool operator==(const std::nullptr_t &, const FourByteScopedPtr<U, I> &rhs);
+	template<typename U, typename I>
 	//NOLINTNEXTLINE(readability-redundant-declaration) - https://github.com/cms-sw/cmssw/issues/20318
-	friend bool operator!=(const std::nullptr_t &, const FourByteScopedPtr<U> &rhs);
+	friend bool operator!=(const std::nullptr_t &, const FourByteScopedPtr<U, I> &rhs);
 
 private:
-	FourBytePtr ptr_{NULL_PTR};
+	// So the allocator can take and hand out ownership in bulk without going through reset()
+	friend Allocator;
+
+	IndexType ptr_{NULL_PTR};
 };
 
 // Allows you to do nullptr == ptr
-template<typename T>
-bool operator==(const std::nullptr_t &, const FourByteScopedPtr<T> &rhs)
+template<typename T, typename I>
+bool operator==(const std::nullptr_t &, const FourByteScopedPtr<T, I> &rhs)
 {
-	return FourByteScopedPtr<T>::NULL_PTR == rhs.ptr_;
+	return FourByteScopedPtr<T, I>::NULL_PTR == rhs.ptr_;
 }
 
-template<typename T>
-bool operator!=(const std::nullptr_t &, const FourByteScopedPtr<T> &rhs)
+template<typename T, typename I>
+bool operator!=(const std::nullptr_t &, const FourByteScopedPtr<T, I> &rhs)
 {
 	return !(nullptr == rhs);
 }
 
-template<typename Allocator>
-FourByteScopedPtr<Allocator>::FourByteScopedPtr(FourBytePtr ptr) : ptr_(ptr)
+template<typename Allocator, typename IndexType>
+FourByteScopedPtr<Allocator, IndexType>::FourByteScopedPtr(IndexType ptr) : ptr_(ptr)
 {
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::CreateNullPtr() -> FourByteScopedPtr
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::CreateNullPtr() -> FourByteScopedPtr
 {
 	return FourByteScopedPtr{NULL_PTR};
 }
 
-template<typename Allocator>
-FourByteScopedPtr<Allocator>::~FourByteScopedPtr()
+template<typename Allocator, typename IndexType>
+FourByteScopedPtr<Allocator, IndexType>::~FourByteScopedPtr()
 {
 	reset();
 }
 
-template<typename Allocator>
-FourByteScopedPtr<Allocator>::FourByteScopedPtr(FourByteScopedPtr &&rhs) noexcept
+template<typename Allocator, typename IndexType>
+FourByteScopedPtr<Allocator, IndexType>::FourByteScopedPtr(FourByteScopedPtr &&rhs) noexcept
 {
 	ptr_ = rhs.ptr_;
 	rhs.ptr_ = NULL_PTR;
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::operator=(FourByteScopedPtr &&rhs) noexcept
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::operator=(FourByteScopedPtr &&rhs) noexcept
 		-> FourByteScopedPtr &
 {
 	if (this != &rhs) {
@@ -107,32 +116,32 @@ auto FourByteScopedPtr<Allocator>::operator=(FourByteScopedPtr &&rhs) noexcept
 	return *this;
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::operator*() -> Type &
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::operator*() -> Type &
 {
 	return *get();
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::operator*() const -> const Type &
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::operator*() const -> const Type &
 {
 	return *get();
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::operator->() -> Type *
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::operator->() -> Type *
 {
 	return get();
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::operator->() const -> const Type *
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::operator->() const -> const Type *
 {
 	return get();
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::reset() -> void
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::reset() -> void
 {
 	if (ptr_ != NULL_PTR) {
 		Allocator::Free(ptr_, get());
@@ -140,8 +149,22 @@ auto FourByteScopedPtr<Allocator>::reset() -> void
 	}
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::get() -> Type *
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::release() -> IndexType
+{
+	const IndexType ptr(ptr_);
+	ptr_ = NULL_PTR;
+	return ptr;
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::Index() const -> IndexType
+{
+	return ptr_;
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::get() -> Type *
 {
 	if (NULL_PTR == ptr_) {
 		return nullptr;
@@ -152,8 +175,8 @@ auto FourByteScopedPtr<Allocator>::get() -> Type *
 	return reinterpret_cast<Type *>(&(Allocator::GetMemory(ptr_)));
 }
 
-template<typename Allocator>
-auto FourByteScopedPtr<Allocator>::get() const -> const Type *
+template<typename Allocator, typename IndexType>
+auto FourByteScopedPtr<Allocator, IndexType>::get() const -> const Type *
 {
 	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
 	return const_cast<FourByteScopedPtr *>(this)->get();
@@ -0,0 +1,192 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * FourByteSharedPtr.h
+ *		A 4 byte shared ownership handle to an element of a pool with the RefCounted or
+ *		AtomicRefCounted option, the pool's answer to std::shared_ptr. The count lives in an array
+ *		beside the element's bucket rather than a separately allocated control block, and the
+ *		element goes back on the free list when the last copy goes. e.g.
+ *
+ *			using Nodes = GrowingGlobalPoolAllocator<Node, 16'384, RefCounted>;
+ *			auto node(nodes.AllocateShared());
+ *			auto alias(node);
+ *			assert(node.use_count() == 2);
+ *
+ *		Otherwise behaves like FourByteScopedPtr, just copyable.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+#pragma once
+
+#include "FourByteScopedPtr.h"
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+namespace hgalloc {
+
+template<typename Allocator, typename IndexType = FourBytePtr>
+class FourByteSharedPtr {
+public:
+	using Type = typename Allocator::Type;
+
+	FourByteSharedPtr() = default;
+	~FourByteSharedPtr();
+
+	// ptr style functions
+	auto operator*() -> Type &;
+	auto operator*() const -> const Type &;
+	auto operator->() -> Type *;
+	auto operator->() const -> const Type *;
+	auto reset() -> void;
+	// The index the handle shares, NULL_PTR if it's null
+	[[nodiscard]] auto Index() const -> IndexType;
+	auto get() -> Type *;
+	[[nodiscard]] auto get() const -> const Type *;
+	// How many handles share the element, 0 if we are null
+	[[nodiscard]] auto use_count() const -> std::size_t;
+
+	// copyable, which adds a reference
+	FourByteSharedPtr(const FourByteSharedPtr &);
+	FourByteSharedPtr &operator=(const FourByteSharedPtr &);
+
+	// moveable
+	FourByteSharedPtr(FourByteSharedPtr &&) noexcept;
+	FourByteSharedPtr &operator=(FourByteSharedPtr &&) noexcept;
+
+	friend auto operator==(const FourByteSharedPtr &, const FourByteSharedPtr &) -> bool = default;
+
+	static constexpr IndexType NULL_PTR{std::numeric_limits<IndexType>::max()};
+
+	template<typename U, typename I>
+	//NOLINTNEXTLINE(readability-redundant-declaration) - https://github.com/cms-sw/cmssw/issues/20318
+	friend bool operator==(const std::nullptr_t &, const FourByteSharedPtr<U, I> &rhs);
+	template<typename U, typename I>
+	//NOLINTNEXTLINE(readability-redundant-declaration) - https://github.com/cms-sw/cmssw/issues/20318
+	friend bool operator!=(const std::nullptr_t &, const FourByteSharedPtr<U, I> &rhs);
+
+private:
+	// Only the allocator makes them, from an element whose count it has already set
+	friend Allocator;
+	explicit FourByteSharedPtr(IndexType ptr);
+
+	IndexType ptr_{NULL_PTR};
+};
+
+// Allows you to do nullptr == ptr
+template<typename T, typename I>
+bool operator==(const std::nullptr_t &, const FourByteSharedPtr<T, I> &rhs)
+{
+	return FourByteSharedPtr<T, I>::NULL_PTR == rhs.ptr_;
+}
+
+template<typename T, typename I>
+bool operator!=(const std::nullptr_t &, const FourByteSharedPtr<T, I> &rhs)
+{
+	return !(nullptr == rhs);
+}
+
+template<typename Allocator, typename IndexType>
+FourByteSharedPtr<Allocator, IndexType>::FourByteSharedPtr(IndexType ptr) : ptr_(ptr)
+{
+}
+
+template<typename Allocator, typename IndexType>
+FourByteSharedPtr<Allocator, IndexType>::~FourByteSharedPtr()
+{
+	reset();
+}
+
+template<typename Allocator, typename IndexType>
+FourByteSharedPtr<Allocator, IndexType>::FourByteSharedPtr(const FourByteSharedPtr &rhs)
+	: ptr_(rhs.ptr_)
+{
+	if (ptr_ != NULL_PTR) { Allocator::AddRef(ptr_); }
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator=(const FourByteSharedPtr &rhs)
+		-> FourByteSharedPtr &
+{
+	// Add ours first, so assigning a handle to itself can't free the element
+	const IndexType ptr(rhs.ptr_);
+	if (ptr != NULL_PTR) { Allocator::AddRef(ptr); }
+	reset();
+	ptr_ = ptr;
+	return *this;
+}
+
+template<typename Allocator, typename IndexType>
+FourByteSharedPtr<Allocator, IndexType>::FourByteSharedPtr(FourByteSharedPtr &&rhs) noexcept
+	: ptr_(std::exchange(rhs.ptr_, NULL_PTR))
+{
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator=(FourByteSharedPtr &&rhs) noexcept
+		-> FourByteSharedPtr &
+{
+	if (this != &rhs) {
+		reset();
+		ptr_ = std::exchange(rhs.ptr_, NULL_PTR);
+	}
+	return *this;
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator*() -> Type &
+{
+	return *get();
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator*() const -> const Type &
+{
+	return *get();
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator->() -> Type *
+{
+	return get();
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::operator->() const -> const Type *
+{
+	return get();
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::reset() -> void
+{
+	if (ptr_ != NULL_PTR) { Allocator::DropRef(std::exchange(ptr_, NULL_PTR)); }
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::Index() const -> IndexType
+{
+	return ptr_;
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::get() -> Type *
+{
+	if (NULL_PTR == ptr_) { return nullptr; }
+	return reinterpret_cast<Type *>(&(Allocator::GetMemory(ptr_)));
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::get() const -> const Type *
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+	return const_cast<FourByteSharedPtr *>(this)->get();
+}
+
+template<typename Allocator, typename IndexType>
+auto FourByteSharedPtr<Allocator, IndexType>::use_count() const -> std::size_t
+{
+	return ptr_ == NULL_PTR ? 0 : Allocator::UseCount(ptr_);
+}
+
+}// namespace hgalloc
@@ -0,0 +1,82 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * FourByteWeakPtr.h
+ *		A 4 byte weak reference to an element of a pool with the Generations option, for things like
+ *		caches that need to notice when what they point at has been freed, without paying for a
+ *		std::weak_ptr and its control block. e.g.
+ *
+ *			using Sessions = GrowingGlobalPoolAllocator<Session, 16'384, Generations<8>>;
+ *			auto session(sessions.Allocate());
+ *			Sessions::WeakPtrType weak(session);
+ *			session.reset();
+ *			assert(weak.lock() == nullptr);
+ *
+ *		It holds the element's index and the generation it had when the weak handle was made, so
+ *		lock() is one compare against the pool's counter for that element. The pool's handles are
+ *		unique owners, so unlike std::weak_ptr lock() can't keep the element alive. It returns a
+ *		plain pointer that is valid until the owner frees the element.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+#pragma once
+
+#include "FourByteScopedPtr.h"
+
+#include <limits>
+
+namespace hgalloc {
+
+template<typename Allocator>
+class FourByteWeakPtr {
+public:
+	using Type = typename Allocator::Type;
+
+	FourByteWeakPtr() = default;
+	explicit FourByteWeakPtr(const typename Allocator::PtrType &ptr);
+
+	// The element, or nullptr if it has been freed since we were made
+	[[nodiscard]] auto lock() const -> Type *;
+	[[nodiscard]] auto expired() const -> bool;
+	auto reset() -> void;
+	// The generation in the top bits and the index below, NULL_PTR if we are null
+	[[nodiscard]] auto Value() const -> FourBytePtr;
+
+	friend auto operator==(const FourByteWeakPtr &, const FourByteWeakPtr &) -> bool = default;
+
+	static constexpr FourBytePtr NULL_PTR{std::numeric_limits<FourBytePtr>::max()};
+
+private:
+	FourBytePtr ptr_{NULL_PTR};
+};
+
+template<typename Allocator>
+FourByteWeakPtr<Allocator>::FourByteWeakPtr(const typename Allocator::PtrType &ptr)
+	: ptr_(Allocator::WeakIndex(ptr))
+{
+}
+
+template<typename Allocator>
+auto FourByteWeakPtr<Allocator>::lock() const -> Type *
+{
+	return Allocator::Lock(ptr_);
+}
+
+template<typename Allocator>
+auto FourByteWeakPtr<Allocator>::expired() const -> bool
+{
+	return lock() == nullptr;
+}
+
+template<typename Allocator>
+auto FourByteWeakPtr<Allocator>::reset() -> void
+{
+	ptr_ = NULL_PTR;
+}
+
+template<typename Allocator>
+auto FourByteWeakPtr<Allocator>::Value() const -> FourBytePtr
+{
+	return ptr_;
+}
+
+}// namespace hgalloc
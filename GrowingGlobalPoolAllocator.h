@@ -8,19 +8,34 @@
  *		from the lowest free list, so if you start using less elements eventually the higher buckets will
  *		become empty. When this happens they are deleted freeing up the memory.
  *		
- *		It returns 4 byte pointers, which behave just like a unique_ptr but are only 4 bytes large. 
+ *		It returns 4 byte pointers, which behave just like a unique_ptr but are only 4 bytes large
+ *		(or 2 or 8 bytes, see HandleType).
  *
  *--------------------------------------------------------------------------------------------------
  */
 
 #pragma once
 
+#include "BucketStorage.h"
 #include "FourByteScopedPtr.h"
+#include "FourByteSharedPtr.h"
+#include "FourByteWeakPtr.h"
+#include "HierarchicalBitmap.h"
+#include "PoolOptions.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <stack>
+#include <thread>
 #include <vector>
 
 namespace hgalloc {
@@ -37,21 +52,93 @@ constexpr auto CountSetBits() -> std::size_t
 	return count;
 }
 
+// A maxElements known at compile time, so the pool can check its handles can index that many, e.g.
+//		GrowingGlobalPoolAllocator<Order, 1'024, TwoByteHandles> orders{MaxElements<60'000>{}};
+template<std::size_t n>
+struct MaxElements {
+	static constexpr std::size_t value{n};
+};
+
+namespace detail {
+
+// Uninitialised storage for adapters that pool raw bytes, the empty constructor stops the pool
+// zeroing every node it hands out. Owner makes each adapter's nodes, and so its pool, a type of
+// its own.
+template<std::size_t size, std::size_t alignment, typename Owner>
+struct alignas(alignment) RawNode {
+	RawNode() {}// NOLINT(modernize-use-equals-default)
+	unsigned char bytes_[size];
+};
+
+}// namespace detail
+
+// A snapshot of a pool, see GrowingGlobalPoolAllocator::GetStats(). The counters are totals since
+// the pool was created.
+struct PoolStats {
+	std::uint64_t allocations{0};
+	// Allocations that returned nullptr because the pool was full. A short AllocateN counts once
+	std::uint64_t failedAllocations{0};
+	std::uint64_t frees{0};
+	// Where the elements came from. ThreadCached pools take them a magazine at a time, so these
+	// can run ahead of allocations
+	std::uint64_t freeListPops{0};
+	std::uint64_t bumpAllocations{0};
+	std::uint64_t bucketsCreated{0};
+	std::uint64_t bucketsEvicted{0};
+
+	std::size_t size{0};
+	std::size_t capacity{0};
+	// The bucket the next allocation will come from if it reuses a free element, NONE if there
+	// are no free elements
+	std::size_t lowestFreeBucket{HierarchicalBitmap<>::NONE};
+	// Elements in use in each bucket the pool has grown into, counting those cached by threads
+	std::vector<std::size_t> bucketOccupancy;
+};
+
 template<
 		// The type to store
 		typename T,
-		std::size_t bucketSize>// the size of each bucket. Must be a power of 2
+		std::size_t bucketSize,// the size of each bucket. Must be a power of 2
+		typename... Options>   // see PoolOptions.h
 class GrowingGlobalPoolAllocator {
 public:
 	using Type = T;
-	using PtrType = FourByteScopedPtr<GrowingGlobalPoolAllocator<T, bucketSize>>;
+	using Handles = SelectOption<HandleOption, FourByteHandles, Options...>;
+	// What handles hold, and what the pool indexes its elements by
+	using IndexType = typename Handles::Type;
+	using PtrType =
+			FourByteScopedPtr<GrowingGlobalPoolAllocator<T, bucketSize, Options...>, IndexType>;
 	friend PtrType;
+	using WeakPtrType = FourByteWeakPtr<GrowingGlobalPoolAllocator<T, bucketSize, Options...>>;
+	using SharedPtrType =
+			FourByteSharedPtr<GrowingGlobalPoolAllocator<T, bucketSize, Options...>, IndexType>;
+	friend SharedPtrType;
+
+	using Threading = SelectOption<ThreadingOption, SingleThreaded, Options...>;
+	using Maintenance = SelectOption<MaintenanceOption, InlineMaintenance, Options...>;
+	using Eviction = SelectOption<EvictionOption, HighestBucketEviction, Options...>;
+	using Stats = SelectOption<StatsOption, NoStats, Options...>;
+	using Layout = SelectOption<LayoutOption, NaturalLayout, Options...>;
+	using LiveTracking = SelectOption<LiveTrackingOption, NoLiveTracking, Options...>;
+	using Generation = SelectOption<GenerationOption, NoGenerations, Options...>;
+	using RefCounts = SelectOption<RefCountOption, NoRefCounts, Options...>;
+	// Unused other than to make differently tagged pools different types
+	using Identity = SelectOption<PoolIdentityOption, Untagged, Options...>;
 
 
 	static_assert(bucketSize > 0, "bucketSize cannot be zero");
 
 	static_assert(CountSetBits<bucketSize>() == 1, "Bucket size must be a power of 2");
 
+	// The most elements the handles can index, as the top index is the null handle. Weak handles
+	// only have the bits below the generation for the index, with the same all ones null.
+	static constexpr std::size_t MAX_ELEMENTS{
+			Generation::bits == 0
+					? PtrType::NULL_PTR
+					: std::min<std::size_t>(PtrType::NULL_PTR,
+											(std::size_t{1} << (32 - Generation::bits)) - 1)};
+	static_assert(bucketSize <= MAX_ELEMENTS, "A bucket has more elements than handles can index");
+
 	// not-movable
 	GrowingGlobalPoolAllocator(GrowingGlobalPoolAllocator &&) = delete;
 	GrowingGlobalPoolAllocator &operator=(GrowingGlobalPoolAllocator &&) = delete;
@@ -60,40 +147,210 @@ public:
 	GrowingGlobalPoolAllocator &operator=(const GrowingGlobalPoolAllocator &) = delete;
 
 	// the max number of elements for the global allocator to store. So for max size its
-	// sizeof(T) * maxElements
+	// sizeof(MemBlock) * maxElements (plus a handle's width an element for PackedLayout, and 4
+	// bytes for RefCounted). Only one pool of a type can exist at a time, use PoolTag if you need
+	// more.
 	explicit GrowingGlobalPoolAllocator(std::size_t maxElements);
+	// The same, but checks maxElements fits in our handles at compile time
+	template<std::size_t maxElements>
+	explicit GrowingGlobalPoolAllocator(MaxElements<maxElements>);
 	~GrowingGlobalPoolAllocator();
 
 	// Returns a unique ptr like object that will free its memory when it exits scope
 	template<typename... Args>
 	auto Allocate(Args &&...) -> PtrType;
 
+	// Allocates up to count elements, each constructed from args, and writes their handles to out.
+	// Returns how many it allocated, which is only less than count if the pool is full. Free
+	// elements are taken a whole free list at a time, then a contiguous range of new ones.
+	template<typename OutputIt, typename... Args>
+	auto AllocateN(std::size_t count, OutputIt out, const Args &...args) -> std::size_t;
+
+	// Frees every element in ptrs and leaves them all null. Runs of elements from the same bucket
+	// are pushed onto its free list in one go and we only check for eviction once.
+	auto FreeN(std::span<PtrType> ptrs) -> void;
+
+	// With RefCounted, an element owned by every copy of the handle and freed when the last one
+	// goes. Share turns a unique handle into a shared one, leaving it null.
+	template<typename... Args>
+	auto AllocateShared(Args &&...) -> SharedPtrType;
+	static auto Share(PtrType &&ptr) -> SharedPtrType;
+
+	// Moves up to maxMoves live elements out of the top buckets into holes in lower ones, so the
+	// top buckets can be freed even if a few long lived elements are left in them. Stops once the
+	// top bucket has more live elements than there are holes below it. Returns how many it moved.
+	//
+	// Handles point at an index, so every element moved gets a new handle. For each one we call
+	//		relocate(T &movedElement, PtrType &&newHandle)
+	// and the owner of the old handle must replace it with the new one (which frees the moved from
+	// element), e.g. by looking the element up by its key. relocate mustn't allocate from the pool
+	// and raw pointers to moved elements are left dangling. SingleThreaded pools only.
+	template<typename Relocate>
+	auto Compact(std::size_t maxMoves, Relocate &&relocate) -> std::size_t;
+
+	// Creates and faults in the bucket the pool will grow into next and, if we have
+	// DeferredMaintenance, frees the buckets evicted since the last call. Keeps one spare evicted
+	// bucket around so a pool hovering around a bucket boundary doesn't keep faulting pages in.
+	// With IdleEviction it evicts the top bucket if it has been idle long enough and keeps no
+	// spare. Takes the same lock as Allocate and Free, so for SingleThreaded pools call it from the
+	// thread that uses the pool.
+	auto Maintain() -> void;
+
 	[[nodiscard]] auto Size() const -> std::size_t;
 	[[nodiscard]] auto Capacity() const -> std::size_t;
 
+	// Adds up every thread's counters (including threads that have exited) and walks the buckets.
+	// Takes the pool's lock while it does, so don't call it on a hot path. Needs CollectStats.
+	[[nodiscard]] auto GetStats() const -> PoolStats;
+
+	// For adapters that hand out plain pointers, see PoolMemoryResource. Contains says whether an
+	// address is inside the pool and Reclaim turns an element given up with PtrType::release()
+	// back into a handle. Both need a storage that can map addresses back to indices, i.e.
+	// ReservedAddressSpace or the huge page storages.
+	[[nodiscard]] static auto Contains(const void *) -> bool;
+	static auto Reclaim(T *element) -> PtrType;
+
+	// For adapters that store bare indices rather than handles, see PoolNodePtr. IndexOf has the
+	// same storage requirement as Reclaim. FreeIndex destroys and frees the element at an index
+	// given up with PtrType::release(), as its handle would have.
+	[[nodiscard]] static auto IndexOf(const T *element) -> IndexType;
+	[[nodiscard]] static auto AddressOf(IndexType) -> T *;
+	static auto FreeIndex(IndexType) -> void;
+
+	// Walks the live elements in memory order, see TrackLiveObjects. fn is called as
+	// fn(T &, IndexType) or fn(T &) and may free the element it is given, or any other. Elements
+	// allocated during the walk may or may not be visited. Other threads mustn't free while we
+	// walk, as a bucket could be evicted under us.
+	class LiveIterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using reference = T &;
+
+		LiveIterator() = default;
+
+		auto operator*() const -> T & { return *AddressOf(Index()); }
+		auto operator->() const -> T * { return AddressOf(Index()); }
+		auto operator++() -> LiveIterator &;
+		auto operator++(int) -> LiveIterator;
+		[[nodiscard]] auto Index() const -> IndexType { return static_cast<IndexType>(index_); }
+
+		friend auto operator==(const LiveIterator &, const LiveIterator &) -> bool = default;
+
+	private:
+		friend GrowingGlobalPoolAllocator;
+		explicit LiveIterator(std::size_t index) : index_(index) {}
+
+		std::size_t index_{HierarchicalBitmap<>::NONE};
+	};
+
+	struct LiveRange {
+		[[nodiscard]] auto begin() const -> LiveIterator;
+		[[nodiscard]] auto end() const -> LiveIterator;
+	};
+
+	template<typename F>
+	static auto ForEachLive(F &&fn) -> void;
+	// ForEachLive split across numThreads threads, the calling thread being one of them. Threads
+	// take a bucket at a time until none are left, so each walks its buckets in order but fn is
+	// called concurrently and mustn't throw. If the pool is thread safe fn may free the element it
+	// is given, but no others as another thread could be visiting them.
+	template<typename F>
+	static auto ForEachLiveParallel(std::size_t numThreads, F &&fn) -> void;
+	[[nodiscard]] static auto LiveObjects() -> LiveRange;
+	[[nodiscard]] static auto IsLive(IndexType) -> bool;
+
+	// With Generations, a weak handle is the element's generation in the top GENERATION_BITS
+	// bits and its index below them, see FourByteWeakPtr. Lock returns nullptr if the element has
+	// been freed since the weak handle was made. Frees racing with Lock on other threads aren't
+	// caught, the element is only safe to use while you know its owner won't free it.
+	[[nodiscard]] static auto WeakIndex(const PtrType &ptr) -> FourBytePtr;
+	[[nodiscard]] static auto Lock(FourBytePtr weak) -> T *;
+
+	static constexpr std::size_t GENERATION_BITS{Generation::bits};
+	static constexpr std::size_t WEAK_INDEX_BITS{32 - GENERATION_BITS};
+
+	// Hands any elements cached by the calling thread back to the shared free lists. Threads do
+	// this automatically when they exit, so you only need it if a thread stops using the pool but
+	// stays alive. Does nothing unless the pool is ThreadCached.
+	static auto FlushThreadCache() -> void;
+
 private:
-	static auto Free(FourBytePtr, T *) -> void;
+	static auto Free(IndexType, T *) -> void;
 
 	// We use a memblock so we can allocate types that are not default constructable
-	struct MemBlock {
-		std::array<char, sizeof(T)> buf;
-	};
+	using MemBlock = typename Layout::template Block<T>;
 
-	static_assert(sizeof(MemBlock) == sizeof(T), "Currently doesn't support packed types");
-	static_assert(sizeof(T) >= sizeof(FourBytePtr),
-				  "We need the size of the object to be at least 4 bytes");
+	static_assert(sizeof(MemBlock) >= sizeof(T) && sizeof(MemBlock) % alignof(T) == 0);
+	static_assert(Layout::outOfBandLinks || sizeof(T) >= sizeof(IndexType),
+				  "We need the object to be at least as big as a handle, or use PackedLayout");
+	static_assert(Layout::outOfBandLinks || !Threading::lockFree ||
+						  sizeof(MemBlock) % alignof(IndexType) == 0,
+				  "LockFree pools access the free list links atomically, so they must be aligned");
+
+	static_assert(!Threading::lockFree || sizeof(IndexType) == sizeof(std::uint32_t),
+				  "LockFree pools swap a handle and a 32 bit generation in one 8 byte CAS");
+	static_assert(Generation::bits == 0 || sizeof(IndexType) <= sizeof(FourBytePtr),
+				  "Weak handles are 4 bytes, so they can't hold a bigger index");
 
 	constexpr static std::size_t BUCKET_MASK{bucketSize - 1};
 
+	// A free list head plus a counter that LockFree pools bump on every change. Being 8 bytes lets
+	// us swap both with a single CAS, so a head that is popped and pushed back between our read and
+	// our CAS (ABA) still fails the CAS.
+	struct alignas(sizeof(std::uint64_t)) TaggedPtr {
+		IndexType ptr_{PtrType::NULL_PTR};
+		std::uint32_t generation_{0};
+	};
+
 	struct FreeList {
 		// We create a linked list of free memory, this means we don't need any extra memory
 		// for our free list and freeing can't throw.
-		FourBytePtr freeList_{PtrType::NULL_PTR};
+		TaggedPtr freeList_{};
 		std::size_t freeListSize_{0};
+		// How many elements of a released bucket have been handed out again, see AnyBucketEviction
+		std::size_t bumped_{0};
 	};
 
+	constexpr static bool ANY_BUCKET_EVICTION{Eviction::kind == EvictionKind::AnyBucket};
+	// Whether elements can be allocated and freed by more than one thread at once
+	constexpr static bool THREAD_SAFE{Threading::magazineSize > 0 || Threading::lockFree};
+
+	// The smallest counter that holds every generation bit
+	using GenerationCounter = std::conditional_t<
+			(GENERATION_BITS <= 8), std::uint8_t,
+			std::conditional_t<(GENERATION_BITS <= 16), std::uint16_t, std::uint32_t>>;
+	static constexpr FourBytePtr WEAK_INDEX_MASK{
+			static_cast<FourBytePtr>((std::uint64_t{1} << WEAK_INDEX_BITS) - 1)};
+	// Atomic if the pool is thread safe, as Lock may read while another thread frees
+	static auto LoadGeneration(IndexType ptr) -> FourBytePtr;
+
+	// Where the buckets live, HeapBuckets unless a StorageOption says otherwise
+	template<typename Block>
+	using StorageOf = typename SelectOption<StorageOption, HeapBuckets,
+											Options...>::template Storage<Block, bucketSize>;
+	using ElementStorage =
+			std::conditional_t<Layout::outOfBandLinks,
+							   LinkedStorage<StorageOf<MemBlock>, StorageOf<IndexType>>,
+							   StorageOf<MemBlock>>;
+	// RefCounted pools keep the counts as a column of the same buckets. Share sets an element's
+	// count, so creating a bucket needn't touch the column's pages.
+	using RefCount = std::uint32_t;
+	using Storage = std::conditional_t<
+			RefCounts::enabled,
+			ColumnStorage<bucketSize, ColumnInit::Default, ElementStorage, StorageOf<RefCount>>,
+			ElementStorage>;
+
+public:
+	// For adapters whose storage keeps more than the elements, see SoaPoolAllocator
+	[[nodiscard]] static auto Buckets() -> const Storage &;
+
+private:
+
 	struct GlobalState {
-		std::vector<std::vector<MemBlock>> buffers_;
+		Storage buckets_;
 		// We create a linked list of free memory, this means we don't need any extra memory
 		// for our free list and freeing can't throw.
 		std::vector<FreeList> freeLists_;
@@ -102,7 +359,26 @@ private:
 		std::size_t totalFreeListSize_{0};
 		std::size_t maxNumOfElements_{0};
 		std::size_t numOfElements_{0};
-		std::size_t smallestBucket_{0};
+		// A bit per bucket set when its free list isn't empty, so finding the lowest free list
+		// costs the same however many buckets we have
+		HierarchicalBitmap<Threading::lockFree> nonEmptyFreeLists_;
+		std::size_t freesSinceEvictionCheck_{0};
+		// Buckets evicted but not yet freed, only used with DeferredMaintenance
+		HierarchicalBitmap<> retiredBuckets_;
+		// Only used with AnyBucketEviction. Buckets below the top whose memory has been released
+		// stay within numOfElements_, we bump allocate back into them before growing and
+		// releasedElements_ counts the elements in them that haven't been handed out again.
+		HierarchicalBitmap<> fullyFreeBuckets_;
+		HierarchicalBitmap<> releasedBuckets_;
+		std::size_t releasedElements_{0};
+		// Only used with IdleEviction, the top bucket we have seen free and since when
+		std::size_t idleBucket_{HierarchicalBitmap<>::NONE};
+		std::chrono::steady_clock::time_point idleSince_{};
+		// Only used with TrackLiveObjects, a bit per element set while it is live. Set and cleared
+		// outside the lock by ThreadCached pools, so it's concurrent if the pool is thread safe
+		HierarchicalBitmap<THREAD_SAFE> liveObjects_;
+		// Only used with Generations, how many times each element has been freed
+		std::vector<GenerationCounter> generations_;
 	};
 
 	// Accessors to static internal state. Makes the lifetime much easier to manage.
@@ -110,16 +386,117 @@ private:
 	static inline struct GlobalState globalState_{
 	};
 
+	// Guards globalState_ when we are ThreadCached, only guards creating buckets when we are
+	// LockFree and is a NullMutex otherwise
+	static inline typename Threading::Mutex mutex_{};
+
+	struct Magazine {
+		std::array<IndexType, Threading::magazineSize> ptrs_;
+		// Only ever written by the owning thread, it's atomic so Size() can read it from others
+		std::atomic<std::size_t> size_{0};
+	};
+
+	struct ThreadCache {
+		ThreadCache() = default;
+		~ThreadCache();
+
+		ThreadCache(const ThreadCache &) = delete;
+		ThreadCache &operator=(const ThreadCache &) = delete;
+
+		std::array<Magazine, 2> magazines_{};
+		Magazine *loaded_{&magazines_[0]};
+		Magazine *previous_{&magazines_[1]};
+		// Which pool instance the cached pointers belong to, see epoch_. Only written under mutex_
+		std::uint64_t epoch_{0};
+		bool registered_{false};
+	};
+
+	// Every live thread cache, so Size() can account for the elements sitting in them
+	static inline std::vector<ThreadCache *> threadCaches_{};
+
+	// Bumped every time a pool is created or destroyed so threads can tell their cache is stale
+	static inline std::atomic<std::uint64_t> epoch_{0};
+
+	// Only used with CollectStats. Only the owning thread writes its counters, they are atomic so
+	// GetStats() can read them from others.
+	struct ThreadStats {
+		ThreadStats() = default;
+		~ThreadStats();
+
+		ThreadStats(const ThreadStats &) = delete;
+		ThreadStats &operator=(const ThreadStats &) = delete;
+
+		auto AddTo(PoolStats &) const -> void;
+
+		std::atomic<std::uint64_t> allocations_{0};
+		std::atomic<std::uint64_t> failedAllocations_{0};
+		std::atomic<std::uint64_t> frees_{0};
+		std::atomic<std::uint64_t> freeListPops_{0};
+		std::atomic<std::uint64_t> bumpAllocations_{0};
+		std::atomic<std::uint64_t> bucketsCreated_{0};
+		std::atomic<std::uint64_t> bucketsEvicted_{0};
+		// Which pool instance the counts belong to, see epoch_. Only written under statsMutex_
+		std::uint64_t epoch_{0};
+		bool registered_{false};
+	};
+
+	// Guards the two below, separate from mutex_ as that is a NullMutex for SingleThreaded pools
+	// but the stats of threads that have exited still need adding up
+	static inline std::mutex statsMutex_{};
+	static inline std::vector<ThreadStats *> liveThreadStats_{};
+	static inline PoolStats exitedThreadStats_{};
+
 	// Convenience accessors to global state members
 	struct BlockAndPtr {
 		MemBlock &memBlock;
-		FourBytePtr ptr;
+		IndexType ptr;
 	};
 
 	static auto PopFreeList() -> BlockAndPtr;
-	static auto PushFreeList(FourBytePtr) -> void;
-	static auto GetMemory(FourBytePtr ptr) -> MemBlock &;
-	static auto GetMemoryOrAlloc(FourBytePtr ptr) -> MemBlock &;
+	static auto PushFreeList(IndexType) -> void;
+	// Hands out the next never used element, or one from a released bucket. NULL_PTR if full
+	static auto BumpAllocate() -> IndexType;
+	static auto MaybeEvict(std::size_t numFreed) -> void;
+	// Releases the top bucket if every element in it is free, returns whether it did
+	static auto EvictHighestBucket() -> bool;
+	static auto EvictIdleBucket() -> void;
+	// AnyBucketEviction only, bucketNum must be completely free
+	static auto ReleaseFreeBucket(std::size_t bucketNum) -> void;
+	static auto ReleaseStorage(std::size_t bucketNum) -> void;
+	// How many elements in the bucket have been handed out at some point
+	static auto ElementsInBucket(std::size_t bucketNum) -> std::size_t;
+
+	static auto AllocateLockFree() -> IndexType;
+	static auto PopFreeListLockFree() -> IndexType;
+	static auto PopFreeListLockFree(std::size_t bucketNum) -> IndexType;
+	static auto PushFreeListLockFree(IndexType) -> void;
+	static auto CreateBucketLockFree(IndexType) -> void;
+
+	static auto LocalThreadCache() -> ThreadCache &;
+	static auto PopThreadCache() -> IndexType;
+	static auto PushThreadCache(IndexType) -> void;
+	static auto RefillMagazine(Magazine &) -> void;
+	static auto DrainMagazine(Magazine &) -> void;
+	static auto LocalThreadStats() -> ThreadStats &;
+	// Adds n to one of the calling thread's counters, does nothing unless we have CollectStats
+	static auto CountStat(std::atomic<std::uint64_t> ThreadStats::*counter, std::uint64_t n = 1)
+			-> void;
+	static auto GetMemory(IndexType ptr) -> MemBlock &;
+	// Walks the live elements in [first, last)
+	template<typename F>
+	static auto ForEachLiveIn(std::size_t first, std::size_t last, F &fn) -> void;
+	// Both do nothing unless we have TrackLiveObjects, and MarkFree bumps the element's generation
+	// if we have Generations
+	static auto MarkLive(IndexType ptr) -> void;
+	static auto MarkFree(IndexType ptr) -> void;
+	// Shared handles' counts, DropRef frees the element when it drops the last reference
+	static auto RefCountOf(IndexType ptr) -> RefCount &;
+	static auto AddRef(IndexType ptr) -> void;
+	static auto DropRef(IndexType ptr) -> void;
+	static auto UseCount(IndexType ptr) -> std::size_t;
+	// The free list link of a free element
+	static auto LinkOf(IndexType ptr) -> IndexType &;
+	static auto GetMemoryOrAlloc(IndexType ptr) -> MemBlock &;
 };
 
 }// namespace hgalloc
@@ -11,8 +11,11 @@
 
 #include "GrowingGlobalPoolAllocator.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 
 // Assertions for testing, but have performance implications so are disabled by default.
 #ifdef HGALLOC_DEBUG_ASSERTIONS
@@ -23,39 +26,75 @@
 
 namespace hgalloc {
 
-template<typename T, std::size_t bs>
-GrowingGlobalPoolAllocator<T, bs>::GrowingGlobalPoolAllocator(std::size_t maxElements)
+template<typename T, std::size_t bs, typename... Os>
+GrowingGlobalPoolAllocator<T, bs, Os...>::GrowingGlobalPoolAllocator(std::size_t maxElements)
 {
 	// TODO - bad size error handling
 	//	static_assert(maxElements >= bucketSize,
 	//				  "maxElements must be greater than or equal to bucket size");
-	//	static_assert(maxElements <= PtrType::MAX_PTR, "Cannot store that many pointer objects");
 	//	static_assert(maxElements > 0, "maxElements cannot be zero");
-	HGALLOC_ASSERT(globalState_.buffers_.empty());
+	// Pass MaxElements to have this checked at compile time
+	HGALLOC_ASSERT(maxElements <= MAX_ELEMENTS);
+	HGALLOC_ASSERT(globalState_.buckets_.NumOfBuckets() == 0);
+
+	std::scoped_lock lock(mutex_);
 
 	// Reset the global state
 	globalState_ = GlobalState{};
-
+	++epoch_;
+	if constexpr (Stats::enabled) {
+		std::scoped_lock statsLock(statsMutex_);
+		exitedThreadStats_ = PoolStats{};
+	}
 
 	const auto numOfBuckets((maxElements / bs) + (maxElements % bs == 0 ? 0 : 1));
 
 	// Resize the buffers
 	globalState_.maxNumOfElements_ = maxElements;
-	globalState_.buffers_.resize(numOfBuckets);
+	globalState_.buckets_ = Storage(numOfBuckets);
 	globalState_.freeLists_.resize(numOfBuckets);
+	globalState_.nonEmptyFreeLists_ = HierarchicalBitmap<Threading::lockFree>(numOfBuckets);
+	if constexpr (Maintenance::deferred) {
+		globalState_.retiredBuckets_ = HierarchicalBitmap<>(numOfBuckets);
+	}
+	if constexpr (ANY_BUCKET_EVICTION) {
+		globalState_.fullyFreeBuckets_ = HierarchicalBitmap<>(numOfBuckets);
+		globalState_.releasedBuckets_ = HierarchicalBitmap<>(numOfBuckets);
+	}
+	if constexpr (LiveTracking::enabled) {
+		globalState_.liveObjects_ = HierarchicalBitmap<THREAD_SAFE>(maxElements);
+	}
+	if constexpr (GENERATION_BITS > 0) {
+		// MAX_ELEMENTS, checked above, already leaves room for the weak handles' null
+		static_assert(MAX_ELEMENTS <= WEAK_INDEX_MASK);
+		globalState_.generations_.assign(maxElements, 0);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<std::size_t maxElements>
+GrowingGlobalPoolAllocator<T, bs, Os...>::GrowingGlobalPoolAllocator(MaxElements<maxElements>)
+	: GrowingGlobalPoolAllocator(maxElements)
+{
+	static_assert(maxElements <= MAX_ELEMENTS, "The handles can't index that many elements");
 }
 
-template<typename T, std::size_t bs>
-GrowingGlobalPoolAllocator<T, bs>::~GrowingGlobalPoolAllocator()
+template<typename T, std::size_t bs, typename... Os>
+GrowingGlobalPoolAllocator<T, bs, Os...>::~GrowingGlobalPoolAllocator()
 {
+	FlushThreadCache();
+
 	if (Size() > 0) {
 		std::cerr << "Pool allocator of type " << typeid(T).name() << " went out of scope with "
 				  << Size() << " elements still allocated";
 		HGALLOC_ASSERT(false);
 	}
 
+	std::scoped_lock lock(mutex_);
+
 	// Reset the global state
 	globalState_ = GlobalState{};
+	++epoch_;
 }
 
 template<std::size_t number>
@@ -71,138 +110,899 @@ constexpr auto MostSignificantBitLocation() -> std::size_t
 	return location;
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::GetMemory(FourBytePtr ptr) -> MemBlock &
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Buckets() -> const Storage &
 {
-	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
-	const std::size_t index(ptr & BUCKET_MASK);
+	return globalState_.buckets_;
+}
 
-	return globalState_.buffers_[bucketNum][index];
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::GetMemory(IndexType ptr) -> MemBlock &
+{
+	return globalState_.buckets_.Get(ptr);
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::GetMemoryOrAlloc(FourBytePtr ptr) -> MemBlock &
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::MarkLive(IndexType ptr) -> void
 {
-	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
+	if constexpr (LiveTracking::enabled) { globalState_.liveObjects_.Set(ptr); }
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::MarkFree(IndexType ptr) -> void
+{
+	if constexpr (LiveTracking::enabled) { globalState_.liveObjects_.Clear(ptr); }
+	if constexpr (GENERATION_BITS > 0) {
+		// Only the thread freeing an element writes its generation, so it needn't be a RMW
+		auto &generation(globalState_.generations_[ptr]);
+		const auto next(static_cast<GenerationCounter>(LoadGeneration(ptr) + 1));
+		if constexpr (THREAD_SAFE) {
+			std::atomic_ref<GenerationCounter>(generation).store(next, std::memory_order_release);
+		} else {
+			generation = next;
+		}
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LoadGeneration(IndexType ptr) -> FourBytePtr
+{
+	auto &generation(globalState_.generations_[ptr]);
+	if constexpr (THREAD_SAFE) {
+		return std::atomic_ref<GenerationCounter>(generation).load(std::memory_order_acquire);
+	} else {
+		return generation;
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::RefCountOf(IndexType ptr) -> RefCount &
+{
+	return globalState_.buckets_.template Column<0>().Get(ptr);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::AddRef(IndexType ptr) -> void
+{
+	if constexpr (RefCounts::atomic) {
+		// The caller already holds a reference, so nothing needs ordering against this
+		std::atomic_ref<RefCount>(RefCountOf(ptr)).fetch_add(1, std::memory_order_relaxed);
+	} else {
+		++RefCountOf(ptr);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::DropRef(IndexType ptr) -> void
+{
+	RefCount left(0);
+	if constexpr (RefCounts::atomic) {
+		// acq_rel so whoever frees sees every other owner's writes to the element
+		left = std::atomic_ref<RefCount>(RefCountOf(ptr)).fetch_sub(1, std::memory_order_acq_rel) -
+			   1;
+	} else {
+		left = --RefCountOf(ptr);
+	}
+	if (left == 0) { Free(ptr, reinterpret_cast<T *>(&GetMemory(ptr))); }
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::UseCount(IndexType ptr) -> std::size_t
+{
+	if constexpr (RefCounts::atomic) {
+		return std::atomic_ref<RefCount>(RefCountOf(ptr)).load(std::memory_order_relaxed);
+	} else {
+		return RefCountOf(ptr);
+	}
+}
 
-	auto &buffers(globalState_.buffers_);
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LinkOf(IndexType ptr) -> IndexType &
+{
+	if constexpr (Layout::outOfBandLinks) {
+		return globalState_.buckets_.Link(ptr);
+	} else {
+		return *reinterpret_cast<IndexType *>(&GetMemory(ptr));
+	}
+}
 
-	if (buffers[bucketNum].empty()) { buffers[bucketNum].resize(bs); }
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::GetMemoryOrAlloc(IndexType ptr) -> MemBlock &
+{
+	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
 
-	const auto index(ptr & BUCKET_MASK);
-	HGALLOC_ASSERT(buffers[bucketNum].size() > index);
+	auto &buckets(globalState_.buckets_);
+	if (!buckets.IsCreated(bucketNum)) {
+		buckets.Create(bucketNum);
+		CountStat(&ThreadStats::bucketsCreated_);
+	}
 
-	return buffers[bucketNum][index];
+	return buckets.Get(ptr);
 }
 
-template<typename T, std::size_t bs>
+template<typename T, std::size_t bs, typename... Os>
 template<typename... Args>
-auto GrowingGlobalPoolAllocator<T, bs>::Allocate(Args &&... args) -> PtrType
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Allocate(Args &&... args) -> PtrType
 {
+	if constexpr (Threading::magazineSize > 0) {
+		const IndexType ptr(PopThreadCache());
+		if (ptr == PtrType::NULL_PTR) {
+			CountStat(&ThreadStats::failedAllocations_);
+			return PtrType::CreateNullPtr();
+		}
+
+		CountStat(&ThreadStats::allocations_);
+		new (&GetMemory(ptr)) T(std::forward<Args>(args)...);// emplace onto our buffer
+		MarkLive(ptr);
+		return PtrType{ptr};
+	}
+
+	if constexpr (Threading::lockFree) {
+		const IndexType ptr(AllocateLockFree());
+		if (ptr == PtrType::NULL_PTR) {
+			CountStat(&ThreadStats::failedAllocations_);
+			return PtrType::CreateNullPtr();
+		}
+
+		CountStat(&ThreadStats::allocations_);
+		new (&GetMemory(ptr)) T(std::forward<Args>(args)...);// emplace onto our buffer
+		MarkLive(ptr);
+		return PtrType{ptr};
+	}
+
 	if (globalState_.totalFreeListSize_ > 0) {
 		// First we check to see if we have any previously freed elements and will use them first
 		auto [block, ptr](PopFreeList());
+		CountStat(&ThreadStats::allocations_);
 		new (&block) T(std::forward<Args>(args)...);// emplace onto our buffer
+		MarkLive(ptr);
 		return PtrType{ptr};
 	}
 
-	// Failing that, find the index into the next element in the vector
-	const std::uint32_t nextIndex(globalState_.numOfElements_);
+	// Failing that, take a new element
+	const IndexType ptr(BumpAllocate());
+	if (ptr == PtrType::NULL_PTR) {
+		CountStat(&ThreadStats::failedAllocations_);
+		return PtrType::CreateNullPtr();
+	}
+
+	CountStat(&ThreadStats::allocations_);
+	new (&GetMemoryOrAlloc(ptr)) T(std::forward<Args>(args)...);// emplace onto our buffer
+	MarkLive(ptr);
+	return PtrType{ptr};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::BumpAllocate() -> IndexType
+{
+	constexpr auto bucketShift(MostSignificantBitLocation<BUCKET_MASK>());
+
+	if constexpr (ANY_BUCKET_EVICTION) {
+		// Grow back into the lowest released bucket before growing the pool
+		const std::size_t bucketNum(globalState_.releasedBuckets_.FindFirst());
+		if (bucketNum != HierarchicalBitmap<>::NONE) {
+			auto &freeList(globalState_.freeLists_[bucketNum]);
+			const auto ptr(static_cast<IndexType>((bucketNum << bucketShift) + freeList.bumped_));
+			if (++freeList.bumped_ == bs) {
+				globalState_.releasedBuckets_.Clear(bucketNum);
+				freeList.bumped_ = 0;
+			}
+			--globalState_.releasedElements_;
+			globalState_.fullyFreeBuckets_.Clear(bucketNum);
+			CountStat(&ThreadStats::bumpAllocations_);
+			return ptr;
+		}
+	}
+
+	// Find the index into the next element in the vector
+	const std::size_t nextIndex(globalState_.numOfElements_);
+	if (nextIndex >= globalState_.maxNumOfElements_) { return PtrType::NULL_PTR; }
+
+	++globalState_.numOfElements_;
+	if constexpr (ANY_BUCKET_EVICTION) {
+		globalState_.fullyFreeBuckets_.Clear(nextIndex >> bucketShift);
+	}
+	CountStat(&ThreadStats::bumpAllocations_);
+	return static_cast<IndexType>(nextIndex);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename OutputIt, typename... Args>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::AllocateN(std::size_t count, OutputIt out,
+														 const Args &...args) -> std::size_t
+{
+	// The thread cache and lock free paths already amortise their synchronisation, so just go one
+	// at a time
+	if constexpr (Threading::magazineSize > 0 || Threading::lockFree) {
+		for (std::size_t i(0); i < count; ++i) {
+			auto ptr(Allocate(args...));
+			if (nullptr == ptr) { return i; }
+			*out++ = std::move(ptr);
+		}
+		return count;
+	}
+
+	// Every element is taken off the pool before it is constructed, so if a constructor throws
+	// the pool is consistent and just needs that one element back
+	const auto construct([&](IndexType ptr, MemBlock &block) {
+		try {
+			new (&block) T(args...);
+		} catch (...) {
+			PushFreeList(ptr);
+			throw;
+		}
+		MarkLive(ptr);
+		*out++ = PtrType{ptr};
+	});
+
+	std::size_t allocated(0);
+
+	// Take whole runs off the lowest free lists
+	while (allocated < count && globalState_.totalFreeListSize_ > 0) {
+		const std::size_t bucketNum(globalState_.nonEmptyFreeLists_.FindFirst());
+		HGALLOC_ASSERT(bucketNum != HierarchicalBitmap<>::NONE);
+		auto &freeList(globalState_.freeLists_[bucketNum]);
+		if constexpr (ANY_BUCKET_EVICTION) { globalState_.fullyFreeBuckets_.Clear(bucketNum); }
+
+		const std::size_t taken(std::min(count - allocated, freeList.freeListSize_));
+		CountStat(&ThreadStats::freeListPops_, taken);
+		for (std::size_t i(0); i < taken; ++i) {
+			const IndexType ptr(freeList.freeList_.ptr_);
+			MemBlock &block(GetMemory(ptr));
+			freeList.freeList_.ptr_ = LinkOf(ptr);
+			--freeList.freeListSize_;
+			--globalState_.totalFreeListSize_;
+			construct(ptr, block);
+		}
+
+		if (freeList.freeListSize_ == 0) { globalState_.nonEmptyFreeLists_.Clear(bucketNum); }
+		allocated += taken;
+	}
+
+	if constexpr (ANY_BUCKET_EVICTION) {
+		// Released buckets are scattered, so they go one at a time
+		for (; allocated < count; ++allocated) {
+			const IndexType ptr(BumpAllocate());
+			if (ptr == PtrType::NULL_PTR) { break; }
+			construct(ptr, GetMemoryOrAlloc(ptr));
+		}
+	} else {
+		// Then bump allocate a contiguous range of new elements
+		const std::size_t first(globalState_.numOfElements_);
+		const std::size_t taken(
+				std::min(count - allocated, globalState_.maxNumOfElements_ - first));
+		CountStat(&ThreadStats::bumpAllocations_, taken);
+		for (std::size_t i(0); i < taken; ++i) {
+			const auto ptr(static_cast<IndexType>(first + i));
+			MemBlock &block(GetMemoryOrAlloc(ptr));
+			++globalState_.numOfElements_;
+			construct(ptr, block);
+		}
+		allocated += taken;
+	}
+
+	CountStat(&ThreadStats::allocations_, allocated);
+	if (allocated < count) { CountStat(&ThreadStats::failedAllocations_); }
+	return allocated;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::FreeN(std::span<PtrType> ptrs) -> void
+{
+	if constexpr (Threading::magazineSize > 0 || Threading::lockFree) {
+		for (auto &ptr : ptrs) { ptr.reset(); }
+		return;
+	}
+
+	std::size_t freed(0);
+
+	// Link each run of elements from the same bucket together then splice the run onto the front
+	// of that bucket's free list
+	auto iter(ptrs.begin());
+	while (iter != ptrs.end()) {
+		if (nullptr == *iter) {
+			++iter;
+			continue;
+		}
+
+		const IndexType head(std::exchange(iter->ptr_, PtrType::NULL_PTR));
+		const std::size_t bucketNum(head >> MostSignificantBitLocation<BUCKET_MASK>());
+		reinterpret_cast<T *>(&GetMemory(head))->~T();
+		MarkFree(head);
+
+		IndexType tail(head);
+		std::size_t runLength(1);
+		for (++iter; iter != ptrs.end(); ++iter) {
+			if (nullptr == *iter) { continue; }
+			if ((iter->ptr_ >> MostSignificantBitLocation<BUCKET_MASK>()) != bucketNum) { break; }
+
+			const IndexType ptr(std::exchange(iter->ptr_, PtrType::NULL_PTR));
+			reinterpret_cast<T *>(&GetMemory(ptr))->~T();
+			MarkFree(ptr);
+			LinkOf(tail) = ptr;
+			tail = ptr;
+			++runLength;
+		}
+
+		auto &freeList(globalState_.freeLists_[bucketNum]);
+		if (freeList.freeList_.ptr_ == PtrType::NULL_PTR) {
+			globalState_.nonEmptyFreeLists_.Set(bucketNum);
+		}
 
-	if (nextIndex < globalState_.maxNumOfElements_) {
-		// We have space, so add element in vector and return that.
-		++globalState_.numOfElements_;
-		new (&GetMemoryOrAlloc(nextIndex)) T(std::forward<Args>(args)...);// emplace onto our buffer
-		return PtrType{nextIndex};
+		LinkOf(tail) = freeList.freeList_.ptr_;
+		freeList.freeList_.ptr_ = head;
+		freeList.freeListSize_ += runLength;
+		globalState_.totalFreeListSize_ += runLength;
+		freed += runLength;
+		if constexpr (ANY_BUCKET_EVICTION) {
+			if (freeList.freeListSize_ == ElementsInBucket(bucketNum)) {
+				globalState_.fullyFreeBuckets_.Set(bucketNum);
+			}
+		}
 	}
 
-	return PtrType::CreateNullPtr();
+	CountStat(&ThreadStats::frees_, freed);
+	MaybeEvict(freed);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename... Args>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::AllocateShared(Args &&... args) -> SharedPtrType
+{
+	return Share(Allocate(std::forward<Args>(args)...));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Share(PtrType &&ptr) -> SharedPtrType
+{
+	static_assert(RefCounts::enabled, "Shared handles need the RefCounted option");
+	const IndexType index(ptr.release());
+	if (index == PtrType::NULL_PTR) { return SharedPtrType{}; }
+
+	// Nobody else can see the element yet, so this needn't be atomic
+	RefCountOf(index) = 1;
+	return SharedPtrType{index};
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::Free(FourBytePtr ptr, T *value) -> void
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Free(IndexType ptr, T *value) -> void
 {
 	if (value == nullptr) { return; }
 
 	value->~T();
+	MarkFree(ptr);
+	CountStat(&ThreadStats::frees_);
+
+	if constexpr (Threading::magazineSize > 0) {
+		PushThreadCache(ptr);
+		return;
+	}
+
+	if constexpr (Threading::lockFree) {
+		PushFreeListLockFree(ptr);
+		return;
+	}
 
 	// Push our record on the front of the free list
 	PushFreeList(ptr);
 
+	MaybeEvict(1);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::MaybeEvict(std::size_t numFreed) -> void
+{
+	if constexpr (Eviction::kind == EvictionKind::Watermarks) {
+		if (globalState_.totalFreeListSize_ <= Eviction::highWatermark * bs) { return; }
+		while (globalState_.totalFreeListSize_ > Eviction::lowWatermark * bs &&
+			   EvictHighestBucket()) {}
+		return;
+	}
+
 	// We don't want to close the second we cross over a threshold
 	constexpr std::size_t numOfFreeElementsBeforeEviction(bs + (bs / 2));
 
-	static std::size_t freeCount(0);
-	freeCount++;
-	if (freeCount == bs) {
-		freeCount = 0;
-
-		if (globalState_.totalFreeListSize_ > numOfFreeElementsBeforeEviction) {
-			const std::size_t highestInsertedPointer(globalState_.numOfElements_ - 1);
-			const std::size_t highestBucket(highestInsertedPointer >>
-											MostSignificantBitLocation<BUCKET_MASK>());
-			HGALLOC_ASSERT(highestBucket <
-						   (globalState_.maxNumOfElements_ / bs) +
-								   (globalState_.maxNumOfElements_ % bs == 0 ? 0 : 1));
-
-
-			const std::size_t highestIndexInBucket(highestInsertedPointer & BUCKET_MASK);
-			const std::size_t bucketSize(highestIndexInBucket + 1);
-
-			auto &freeList(globalState_.freeLists_[highestBucket]);
-			if (freeList.freeListSize_ == bucketSize) {
-				// we can evict an entire frame
-				freeList.freeListSize_ = 0;
-				freeList.freeList_ = PtrType::NULL_PTR;
-				globalState_.totalFreeListSize_ -= bucketSize;
-				globalState_.numOfElements_ -= bucketSize;
-				// From http://www.cplusplus.com/reference/vector/vector/clear/ as a way to force
-				// reallocation
-				std::vector<MemBlock>().swap(globalState_.buffers_[highestBucket]);
+	globalState_.freesSinceEvictionCheck_ += numFreed;
+	if (globalState_.freesSinceEvictionCheck_ < bs) { return; }
+	globalState_.freesSinceEvictionCheck_ = 0;
+
+	if constexpr (Eviction::kind == EvictionKind::Idle) {
+		EvictIdleBucket();
+	} else if constexpr (ANY_BUCKET_EVICTION) {
+		while (globalState_.totalFreeListSize_ > numOfFreeElementsBeforeEviction) {
+			const std::size_t bucketNum(globalState_.fullyFreeBuckets_.FindLast());
+			if (bucketNum == HierarchicalBitmap<>::NONE) { break; }
+			ReleaseFreeBucket(bucketNum);
+		}
+	} else {
+		// A batch of frees can empty more than one bucket, so keep going until the top one is used
+		while (globalState_.totalFreeListSize_ > numOfFreeElementsBeforeEviction &&
+			   EvictHighestBucket()) {}
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::EvictHighestBucket() -> bool
+{
+	constexpr auto bucketShift(MostSignificantBitLocation<BUCKET_MASK>());
+
+	if (globalState_.numOfElements_ == 0) { return false; }
+
+	const std::size_t highestBucket((globalState_.numOfElements_ - 1) >> bucketShift);
+	HGALLOC_ASSERT(highestBucket < (globalState_.maxNumOfElements_ / bs) +
+										   (globalState_.maxNumOfElements_ % bs == 0 ? 0 : 1));
+
+	const std::size_t bucketSize(globalState_.numOfElements_ - (highestBucket << bucketShift));
+	const std::size_t elementsInBucket(ElementsInBucket(highestBucket));
+
+	auto &freeList(globalState_.freeLists_[highestBucket]);
+	if (freeList.freeListSize_ != elementsInBucket) { return false; }
+
+	// we can evict an entire frame
+	freeList.freeListSize_ = 0;
+	freeList.freeList_.ptr_ = PtrType::NULL_PTR;
+	globalState_.nonEmptyFreeLists_.Clear(highestBucket);
+	globalState_.totalFreeListSize_ -= elementsInBucket;
+	globalState_.numOfElements_ -= bucketSize;
+	ReleaseStorage(highestBucket);
+	CountStat(&ThreadStats::bucketsEvicted_);
+
+	if constexpr (ANY_BUCKET_EVICTION) {
+		globalState_.fullyFreeBuckets_.Clear(highestBucket);
+		if (globalState_.releasedBuckets_.Test(highestBucket)) {
+			globalState_.releasedBuckets_.Clear(highestBucket);
+			globalState_.releasedElements_ -= bucketSize - elementsInBucket;
+			freeList.bumped_ = 0;
+		}
+
+		// Released buckets we haven't grown back into are already gone, so drop them off the top
+		while (globalState_.numOfElements_ > 0) {
+			const std::size_t bucketNum((globalState_.numOfElements_ - 1) >> bucketShift);
+			if (!globalState_.releasedBuckets_.Test(bucketNum) ||
+				globalState_.freeLists_[bucketNum].bumped_ != 0) {
+				break;
+			}
+			globalState_.releasedBuckets_.Clear(bucketNum);
+			globalState_.releasedElements_ -= bs;
+			globalState_.numOfElements_ -= bs;
+		}
+	}
+	return true;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::EvictIdleBucket() -> void
+{
+	if (globalState_.numOfElements_ == 0) { return; }
+
+	const std::size_t highestBucket((globalState_.numOfElements_ - 1) >>
+									MostSignificantBitLocation<BUCKET_MASK>());
+	if (globalState_.freeLists_[highestBucket].freeListSize_ != ElementsInBucket(highestBucket)) {
+		globalState_.idleBucket_ = HierarchicalBitmap<>::NONE;
+		return;
+	}
+
+	const auto now(std::chrono::steady_clock::now());
+	if (globalState_.idleBucket_ != highestBucket) {
+		globalState_.idleBucket_ = highestBucket;
+		globalState_.idleSince_ = now;
+		return;
+	}
+
+	if (now - globalState_.idleSince_ < Eviction::idleTime) { return; }
+
+	EvictHighestBucket();
+	globalState_.idleBucket_ = HierarchicalBitmap<>::NONE;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ReleaseFreeBucket(std::size_t bucketNum) -> void
+{
+	HGALLOC_ASSERT(globalState_.freeLists_[bucketNum].freeListSize_ == ElementsInBucket(bucketNum));
+
+	const std::size_t highestBucket((globalState_.numOfElements_ - 1) >>
+									MostSignificantBitLocation<BUCKET_MASK>());
+	if (bucketNum == highestBucket) {
+		EvictHighestBucket();
+		return;
+	}
+
+	// Everything in the bucket goes back to being untouched, we'll bump allocate into it again
+	auto &freeList(globalState_.freeLists_[bucketNum]);
+	globalState_.totalFreeListSize_ -= freeList.freeListSize_;
+	globalState_.releasedElements_ += freeList.freeListSize_;
+	freeList = FreeList{};
+	globalState_.nonEmptyFreeLists_.Clear(bucketNum);
+	globalState_.fullyFreeBuckets_.Clear(bucketNum);
+	globalState_.releasedBuckets_.Set(bucketNum);
+	ReleaseStorage(bucketNum);
+	CountStat(&ThreadStats::bucketsEvicted_);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ReleaseStorage(std::size_t bucketNum) -> void
+{
+	if constexpr (Maintenance::deferred) {
+		globalState_.retiredBuckets_.Set(bucketNum);
+	} else {
+		globalState_.buckets_.Release(bucketNum);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ElementsInBucket(std::size_t bucketNum)
+		-> std::size_t
+{
+	if constexpr (ANY_BUCKET_EVICTION) {
+		if (globalState_.releasedBuckets_.Test(bucketNum)) {
+			return globalState_.freeLists_[bucketNum].bumped_;
+		}
+	}
+	const std::size_t firstInBucket(bucketNum << MostSignificantBitLocation<BUCKET_MASK>());
+	return std::min(bs, globalState_.numOfElements_ - firstInBucket);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Maintain() -> void
+{
+	std::scoped_lock lock(mutex_);
+
+	// Idle pools are meant to shrink all the way, so they don't keep a spare bucket either
+	constexpr bool idleEviction(Eviction::kind == EvictionKind::Idle && !Threading::lockFree);
+	if constexpr (idleEviction) { EvictIdleBucket(); }
+
+	// The first bucket the pool hasn't started using
+	const std::atomic_ref numOfElements(globalState_.numOfElements_);
+	const std::size_t nextBucket((numOfElements.load(std::memory_order_relaxed) + bs - 1) / bs);
+
+	if constexpr (Maintenance::deferred) {
+		auto &retired(globalState_.retiredBuckets_);
+		for (std::size_t bucketNum(retired.FindFirst()); bucketNum != HierarchicalBitmap<>::NONE;
+			 bucketNum = retired.FindFirst()) {
+			retired.Clear(bucketNum);
+			// Anything below nextBucket has been grown back into since it was evicted, unless it
+			// is a released bucket we haven't bumped back into yet
+			bool release(bucketNum > nextBucket || (idleEviction && bucketNum == nextBucket));
+			if constexpr (ANY_BUCKET_EVICTION) {
+				release = release || (globalState_.releasedBuckets_.Test(bucketNum) &&
+									  globalState_.freeLists_[bucketNum].bumped_ == 0);
+			}
+			if (release) { globalState_.buckets_.Release(bucketNum); }
+		}
+	}
+
+	auto &buckets(globalState_.buckets_);
+	if (!idleEviction && nextBucket < buckets.NumOfBuckets() && !buckets.IsCreated(nextBucket)) {
+		buckets.Create(nextBucket, true);
+		CountStat(&ThreadStats::bucketsCreated_);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename Relocate>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Compact(std::size_t maxMoves, Relocate &&relocate)
+		-> std::size_t
+{
+	static_assert(Threading::magazineSize == 0 && !Threading::lockFree,
+				  "Compact is only supported by SingleThreaded pools");
+	static_assert(std::is_move_constructible_v<T>, "Compact moves elements so T must be movable");
+	static_assert(!RefCounts::enabled, "Compact can't hand a moved element to all its owners");
+
+	std::size_t moves(0);
+	std::vector<bool> isFree;
+
+	while (moves < maxMoves && globalState_.numOfElements_ > 0) {
+		const std::size_t highestInsertedPointer(globalState_.numOfElements_ - 1);
+		const std::size_t highestBucket(highestInsertedPointer >>
+										MostSignificantBitLocation<BUCKET_MASK>());
+		const std::size_t firstInBucket(highestBucket << MostSignificantBitLocation<BUCKET_MASK>());
+		const auto &freeList(globalState_.freeLists_[highestBucket]);
+
+		// Only worth it if everything left in the top bucket fits in the holes below it
+		const std::size_t elementsInBucket(ElementsInBucket(highestBucket));
+		const std::size_t live(elementsInBucket - freeList.freeListSize_);
+		const std::size_t holesBelow(globalState_.totalFreeListSize_ - freeList.freeListSize_);
+		if (live > holesBelow) { break; }
+
+		if (live > 0) {
+			isFree.assign(bs, false);
+			for (IndexType ptr(freeList.freeList_.ptr_); ptr != PtrType::NULL_PTR;
+				 ptr = LinkOf(ptr)) {
+				isFree[ptr - firstInBucket] = true;
+			}
+
+			for (std::size_t ptr(firstInBucket + elementsInBucket); ptr-- > firstInBucket;) {
+				if (isFree[ptr - firstInBucket]) { continue; }
+				if (moves == maxMoves) { return moves; }
+
+				// The lowest hole is always below us as the top bucket's free list is the highest
+				auto [block, newPtr](PopFreeList());
+				HGALLOC_ASSERT(newPtr < firstInBucket);
+				auto &element(*reinterpret_cast<T *>(&GetMemory(static_cast<IndexType>(ptr))));
+				auto *const moved(new (&block) T(std::move(element)));
+				MarkLive(newPtr);
+				++moves;
+
+				// The owner swaps their handle for the new one, which frees the old element
+				relocate(*moved, PtrType{newPtr});
 			}
 		}
+
+		// If an owner didn't take their new handle the old element is still live so we can't go on
+		if (!EvictHighestBucket()) { break; }
 	}
+
+	return moves;
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::Size() const -> std::size_t
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Size() const -> std::size_t
 {
-	return globalState_.numOfElements_ - globalState_.totalFreeListSize_;
+	if constexpr (Threading::lockFree) {
+		const std::atomic_ref numOfElements(globalState_.numOfElements_);
+		const std::atomic_ref totalFreeListSize(globalState_.totalFreeListSize_);
+		return numOfElements.load(std::memory_order_relaxed) -
+			   totalFreeListSize.load(std::memory_order_relaxed);
+	}
+
+	std::scoped_lock lock(mutex_);
+
+	std::size_t cachedElements(0);
+	if constexpr (Threading::magazineSize > 0) {
+		const auto epoch(epoch_.load(std::memory_order_relaxed));
+		for (const ThreadCache *cache : threadCaches_) {
+			if (cache->epoch_ != epoch) { continue; }
+			for (const auto &magazine : cache->magazines_) {
+				cachedElements += magazine.size_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	return globalState_.numOfElements_ - globalState_.totalFreeListSize_ -
+		   globalState_.releasedElements_ - cachedElements;
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::Capacity() const -> std::size_t
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Capacity() const -> std::size_t
 {
 	return globalState_.maxNumOfElements_;
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::PopFreeList() -> BlockAndPtr
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Contains(const void *ptr) -> bool
 {
-	auto &freeLists(globalState_.freeLists_);
-	for (std::size_t i(globalState_.smallestBucket_); i < globalState_.buffers_.size(); ++i) {
-		auto &freeList(freeLists[i]);
-		if (freeList.freeList_ != PtrType::NULL_PTR) {
-			HGALLOC_ASSERT(freeList.freeListSize_ > 0);
+	return globalState_.buckets_.Contains(ptr);
+}
 
-			const FourBytePtr nextElement(freeList.freeList_);
-			MemBlock &element(GetMemory(nextElement));
-			freeList.freeList_ = *reinterpret_cast<FourBytePtr *>(&element);
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Reclaim(T *element) -> PtrType
+{
+	if (element == nullptr) { return PtrType::CreateNullPtr(); }
+	return PtrType{IndexOf(element)};
+}
 
-			--freeList.freeListSize_;
-			globalState_.smallestBucket_ = i;
-			--globalState_.totalFreeListSize_;
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::FreeIndex(IndexType ptr) -> void
+{
+	HGALLOC_ASSERT(ptr != PtrType::NULL_PTR);
+	Free(ptr, AddressOf(ptr));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::IndexOf(const T *element) -> IndexType
+{
+	return static_cast<IndexType>(
+			globalState_.buckets_.IndexOf(reinterpret_cast<const MemBlock *>(element)));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::AddressOf(IndexType ptr) -> T *
+{
+	return reinterpret_cast<T *>(&GetMemory(ptr));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename F>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ForEachLive(F &&fn) -> void
+{
+	static_assert(LiveTracking::enabled, "ForEachLive needs the TrackLiveObjects option");
+	ForEachLiveIn(0, globalState_.maxNumOfElements_, fn);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename F>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ForEachLiveParallel(std::size_t numThreads, F &&fn)
+		-> void
+{
+	static_assert(LiveTracking::enabled, "ForEachLiveParallel needs the TrackLiveObjects option");
+	HGALLOC_ASSERT(numThreads > 0);
+
+	const std::size_t numOfElements(globalState_.maxNumOfElements_);
+	const std::size_t numOfBuckets(globalState_.buckets_.NumOfBuckets());
+	std::atomic<std::size_t> nextBucket{0};
+	const auto walkBuckets([&] {
+		for (std::size_t bucketNum(nextBucket.fetch_add(1, std::memory_order_relaxed));
+			 bucketNum < numOfBuckets;
+			 bucketNum = nextBucket.fetch_add(1, std::memory_order_relaxed)) {
+			ForEachLiveIn(bucketNum * bs, std::min((bucketNum + 1) * bs, numOfElements), fn);
+		}
+	});
+
+	// No more threads than buckets, the rest would have nothing to do
+	std::vector<std::jthread> threads;
+	threads.reserve(std::min(numThreads, numOfBuckets));
+	for (std::size_t i(1); i < std::min(numThreads, numOfBuckets); ++i) {
+		threads.emplace_back(walkBuckets);
+	}
+	walkBuckets();
+}
+
+template<typename T, std::size_t bs, typename... Os>
+template<typename F>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ForEachLiveIn(std::size_t first, std::size_t last,
+															   F &fn) -> void
+{
+	constexpr std::size_t wordBits(std::numeric_limits<std::uint64_t>::digits);
+	const auto &live(globalState_.liveObjects_);
+
+	// Walk a word's bits ourselves and only go back to the bitmap to skip to the next word
+	for (std::size_t index(live.FindNext(first)); index < last;) {
+		const std::size_t wordStart(index & ~(wordBits - 1));
+		// Bits at or past last belong to someone else, when a bucket doesn't end on a word
+		const std::uint64_t inRange(last - wordStart >= wordBits
+											? ~std::uint64_t{0}
+											: (std::uint64_t{1} << (last - wordStart)) - 1);
+		std::uint64_t word(live.WordContaining(wordStart) & inRange &
+						   (~std::uint64_t{0} << (index - wordStart)));
+		while (word != 0) {
+			const auto bit(static_cast<std::size_t>(std::countr_zero(word)));
+			const auto ptr(static_cast<IndexType>(wordStart + bit));
+			if constexpr (std::is_invocable_v<F &, T &, IndexType>) {
+				fn(*AddressOf(ptr), ptr);
+			} else {
+				fn(*AddressOf(ptr));
+			}
+			// fn may have freed any element, so reread what's left of the word
+			word = bit + 1 == wordBits ? 0
+									   : live.WordContaining(wordStart) & inRange &
+												 (~std::uint64_t{0} << (bit + 1));
+		}
+		if (wordStart + wordBits >= last) { break; }
+		index = live.FindNext(wordStart + wordBits);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LiveObjects() -> LiveRange
+{
+	static_assert(LiveTracking::enabled, "LiveObjects needs the TrackLiveObjects option");
+	return LiveRange{};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::IsLive(IndexType ptr) -> bool
+{
+	static_assert(LiveTracking::enabled, "IsLive needs the TrackLiveObjects option");
+	return globalState_.liveObjects_.Test(ptr);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::WeakIndex(const PtrType &ptr) -> FourBytePtr
+{
+	static_assert(GENERATION_BITS > 0, "Weak handles need the Generations option");
+	if (nullptr == ptr) { return WeakPtrType::NULL_PTR; }
+	// Shifted up by the index bits, so only the generation bits survive
+	return static_cast<FourBytePtr>(LoadGeneration(ptr.ptr_) << WEAK_INDEX_BITS) | ptr.ptr_;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::Lock(FourBytePtr weak) -> T *
+{
+	static_assert(GENERATION_BITS > 0, "Weak handles need the Generations option");
+	if (weak == WeakPtrType::NULL_PTR) { return nullptr; }
+
+	const auto ptr(static_cast<IndexType>(weak & WEAK_INDEX_MASK));
+	HGALLOC_ASSERT(ptr < globalState_.maxNumOfElements_);
+	const auto generation(static_cast<FourBytePtr>(LoadGeneration(ptr) << WEAK_INDEX_BITS));
+	if (generation != (weak & ~WEAK_INDEX_MASK)) { return nullptr; }
+	// A matching generation means it hasn't been freed, so its bucket can't have been evicted
+	return reinterpret_cast<T *>(&GetMemory(ptr));
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LiveRange::begin() const -> LiveIterator
+{
+	return LiveIterator{globalState_.liveObjects_.FindNext(0)};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LiveRange::end() const -> LiveIterator
+{
+	return LiveIterator{};
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LiveIterator::operator++() -> LiveIterator &
+{
+	index_ = globalState_.liveObjects_.FindNext(index_ + 1);
+	return *this;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LiveIterator::operator++(int) -> LiveIterator
+{
+	const LiveIterator ret(*this);
+	++*this;
+	return ret;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::GetStats() const -> PoolStats
+{
+	static_assert(Stats::enabled, "GetStats needs the CollectStats option");
 
-			return {element, nextElement};
+	PoolStats stats;
+	{
+		std::scoped_lock lock(statsMutex_);
+		stats = exitedThreadStats_;
+		const auto epoch(epoch_.load(std::memory_order_relaxed));
+		for (const ThreadStats *threadStats : liveThreadStats_) {
+			if (threadStats->epoch_ == epoch) { threadStats->AddTo(stats); }
 		}
-		HGALLOC_ASSERT(freeList.freeListSize_ == 0);
 	}
 
-	assert(false);
+	stats.size = Size();
+	stats.capacity = Capacity();
+
+	std::scoped_lock lock(mutex_);
+
+	// LockFree pools change under us, so these are only approximate for them
+	const std::size_t numOfElements(
+			std::atomic_ref(globalState_.numOfElements_).load(std::memory_order_relaxed));
+	const std::size_t numOfBuckets((numOfElements + bs - 1) / bs);
+	stats.bucketOccupancy.resize(numOfBuckets);
+	for (std::size_t bucketNum(0); bucketNum < numOfBuckets; ++bucketNum) {
+		std::size_t elementsInBucket(std::min(bs, numOfElements - bucketNum * bs));
+		if constexpr (ANY_BUCKET_EVICTION) {
+			if (globalState_.releasedBuckets_.Test(bucketNum)) {
+				elementsInBucket = globalState_.freeLists_[bucketNum].bumped_;
+			}
+		}
+		const std::size_t numFree(std::atomic_ref(globalState_.freeLists_[bucketNum].freeListSize_)
+										  .load(std::memory_order_relaxed));
+		stats.bucketOccupancy[bucketNum] = elementsInBucket - std::min(elementsInBucket, numFree);
+	}
+	stats.lowestFreeBucket = globalState_.nonEmptyFreeLists_.FindFirst();
+
+	return stats;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PopFreeList() -> BlockAndPtr
+{
+	const std::size_t bucketNum(globalState_.nonEmptyFreeLists_.FindFirst());
+	HGALLOC_ASSERT(bucketNum != HierarchicalBitmap<>::NONE);
+
+	auto &freeList(globalState_.freeLists_[bucketNum]);
+	HGALLOC_ASSERT(freeList.freeListSize_ > 0);
+
+	const IndexType nextElement(freeList.freeList_.ptr_);
+	MemBlock &element(GetMemory(nextElement));
+	freeList.freeList_.ptr_ = LinkOf(nextElement);
+
+	--freeList.freeListSize_;
+	--globalState_.totalFreeListSize_;
+	if (freeList.freeList_.ptr_ == PtrType::NULL_PTR) {
+		globalState_.nonEmptyFreeLists_.Clear(bucketNum);
+	}
+	CountStat(&ThreadStats::freeListPops_);
+	if constexpr (ANY_BUCKET_EVICTION) { globalState_.fullyFreeBuckets_.Clear(bucketNum); }
+
+	return {element, nextElement};
 }
 
-template<typename T, std::size_t bs>
-auto GrowingGlobalPoolAllocator<T, bs>::PushFreeList(FourBytePtr ptr) -> void
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PushFreeList(IndexType ptr) -> void
 {
 	HGALLOC_ASSERT(ptr != PtrType::NULL_PTR);
 	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
@@ -211,14 +1011,344 @@ auto GrowingGlobalPoolAllocator<T, bs>::PushFreeList(FourBytePtr ptr) -> void
 
 	auto &freeList(globalState_.freeLists_[bucketNum]);
 
-	*reinterpret_cast<FourBytePtr *>(&GetMemory(ptr)) = freeList.freeList_;
-	freeList.freeList_ = ptr;
+	if (freeList.freeList_.ptr_ == PtrType::NULL_PTR) {
+		globalState_.nonEmptyFreeLists_.Set(bucketNum);
+	}
+
+	LinkOf(ptr) = freeList.freeList_.ptr_;
+	freeList.freeList_.ptr_ = ptr;
 
 	++globalState_.totalFreeListSize_;
 	++freeList.freeListSize_;
 
-	globalState_.smallestBucket_ = std::min(globalState_.smallestBucket_, bucketNum);
+	if constexpr (ANY_BUCKET_EVICTION) {
+		if (freeList.freeListSize_ == ElementsInBucket(bucketNum)) {
+			globalState_.fullyFreeBuckets_.Set(bucketNum);
+		}
+	}
+}
+
+
+template<typename T, std::size_t bs, typename... Os>
+GrowingGlobalPoolAllocator<T, bs, Os...>::ThreadCache::~ThreadCache()
+{
+	FlushThreadCache();
+
+	std::scoped_lock lock(mutex_);
+	if (registered_) { std::erase(threadCaches_, this); }
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LocalThreadCache() -> ThreadCache &
+{
+	// Function local rather than a static member, GCC 12 can emit a duplicate TLS guard for
+	// thread_local static members of many instantiations in one translation unit
+	static thread_local ThreadCache cache;
+
+	// If the pool has been recreated since we last used it anything we have cached points into
+	// the old pool, so just forget about it.
+	const auto epoch(epoch_.load(std::memory_order_relaxed));
+	if (cache.epoch_ != epoch) {
+		std::scoped_lock lock(mutex_);
+		cache.loaded_->size_.store(0, std::memory_order_relaxed);
+		cache.previous_->size_.store(0, std::memory_order_relaxed);
+		cache.epoch_ = epoch;
+
+		if (!cache.registered_) {
+			threadCaches_.push_back(&cache);
+			cache.registered_ = true;
+		}
+	}
+
+	return cache;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PopThreadCache() -> IndexType
+{
+	auto &cache(LocalThreadCache());
+
+	if (cache.loaded_->size_.load(std::memory_order_relaxed) == 0) {
+		if (cache.previous_->size_.load(std::memory_order_relaxed) == 0) {
+			RefillMagazine(*cache.loaded_);
+		} else {
+			std::swap(cache.loaded_, cache.previous_);
+		}
+	}
+
+	auto &magazine(*cache.loaded_);
+	const auto size(magazine.size_.load(std::memory_order_relaxed));
+	if (size == 0) { return PtrType::NULL_PTR; }
+
+	magazine.size_.store(size - 1, std::memory_order_relaxed);
+	return magazine.ptrs_[size - 1];
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PushThreadCache(IndexType ptr) -> void
+{
+	auto &cache(LocalThreadCache());
+
+	if (cache.loaded_->size_.load(std::memory_order_relaxed) == Threading::magazineSize) {
+		// Keeping the previous magazine around means a thread bouncing around a magazine boundary
+		// doesn't hit the lock every call.
+		if (cache.previous_->size_.load(std::memory_order_relaxed) == Threading::magazineSize) {
+			DrainMagazine(*cache.previous_);
+		}
+		std::swap(cache.loaded_, cache.previous_);
+	}
+
+	auto &magazine(*cache.loaded_);
+	const auto size(magazine.size_.load(std::memory_order_relaxed));
+	magazine.ptrs_[size] = ptr;
+	magazine.size_.store(size + 1, std::memory_order_relaxed);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::RefillMagazine(Magazine &magazine) -> void
+{
+	std::scoped_lock lock(mutex_);
+
+	std::size_t size(magazine.size_.load(std::memory_order_relaxed));
+	HGALLOC_ASSERT(size == 0);
+
+	while (size < Threading::magazineSize) {
+		if (globalState_.totalFreeListSize_ > 0) {
+			magazine.ptrs_[size++] = PopFreeList().ptr;
+		} else {
+			const IndexType ptr(BumpAllocate());
+			if (ptr == PtrType::NULL_PTR) { break; }
+			GetMemoryOrAlloc(ptr);
+			magazine.ptrs_[size++] = ptr;
+		}
+	}
+
+	magazine.size_.store(size, std::memory_order_relaxed);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::DrainMagazine(Magazine &magazine) -> void
+{
+	const auto size(magazine.size_.load(std::memory_order_relaxed));
+	if (size == 0) { return; }
+
+	std::scoped_lock lock(mutex_);
+
+	for (std::size_t i(0); i < size; ++i) { PushFreeList(magazine.ptrs_[i]); }
+
+	magazine.size_.store(0, std::memory_order_relaxed);
+	MaybeEvict(size);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::FlushThreadCache() -> void
+{
+	if constexpr (Threading::magazineSize > 0) {
+		auto &cache(LocalThreadCache());
+		DrainMagazine(*cache.loaded_);
+		DrainMagazine(*cache.previous_);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+GrowingGlobalPoolAllocator<T, bs, Os...>::ThreadStats::~ThreadStats()
+{
+	std::scoped_lock lock(statsMutex_);
+	if (!registered_) { return; }
+
+	// Keep what we counted for GetStats(), unless it was for a pool that has since gone
+	if (epoch_ == GrowingGlobalPoolAllocator::epoch_.load(std::memory_order_relaxed)) {
+		AddTo(exitedThreadStats_);
+	}
+	std::erase(liveThreadStats_, this);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::ThreadStats::AddTo(PoolStats &stats) const -> void
+{
+	stats.allocations += allocations_.load(std::memory_order_relaxed);
+	stats.failedAllocations += failedAllocations_.load(std::memory_order_relaxed);
+	stats.frees += frees_.load(std::memory_order_relaxed);
+	stats.freeListPops += freeListPops_.load(std::memory_order_relaxed);
+	stats.bumpAllocations += bumpAllocations_.load(std::memory_order_relaxed);
+	stats.bucketsCreated += bucketsCreated_.load(std::memory_order_relaxed);
+	stats.bucketsEvicted += bucketsEvicted_.load(std::memory_order_relaxed);
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::LocalThreadStats() -> ThreadStats &
+{
+	static thread_local ThreadStats threadStats;
+
+	// Counts for a previous pool don't belong to this one, so start again
+	const auto epoch(epoch_.load(std::memory_order_relaxed));
+	if (threadStats.epoch_ != epoch) {
+		std::scoped_lock lock(statsMutex_);
+		for (auto *counter : {&threadStats.allocations_, &threadStats.failedAllocations_,
+							  &threadStats.frees_, &threadStats.freeListPops_,
+							  &threadStats.bumpAllocations_, &threadStats.bucketsCreated_,
+							  &threadStats.bucketsEvicted_}) {
+			counter->store(0, std::memory_order_relaxed);
+		}
+		threadStats.epoch_ = epoch;
+
+		if (!threadStats.registered_) {
+			liveThreadStats_.push_back(&threadStats);
+			threadStats.registered_ = true;
+		}
+	}
+
+	return threadStats;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::CountStat(
+		std::atomic<std::uint64_t> ThreadStats::*counter, std::uint64_t n) -> void
+{
+	if constexpr (Stats::enabled) {
+		// Only we write to our counters, so there's no need for a read-modify-write
+		auto &count(LocalThreadStats().*counter);
+		count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::AllocateLockFree() -> IndexType
+{
+	std::atomic_ref totalFreeListSize(globalState_.totalFreeListSize_);
+	std::atomic_ref numOfElements(globalState_.numOfElements_);
+
+	while (true) {
+		if (totalFreeListSize.load(std::memory_order_relaxed) > 0) {
+			const IndexType ptr(PopFreeListLockFree());
+			if (ptr != PtrType::NULL_PTR) { return ptr; }
+		}
+
+		std::size_t nextIndex(numOfElements.load(std::memory_order_relaxed));
+		while (nextIndex < globalState_.maxNumOfElements_) {
+			if (numOfElements.compare_exchange_weak(nextIndex, nextIndex + 1,
+													std::memory_order_relaxed)) {
+				CountStat(&ThreadStats::bumpAllocations_);
+				CreateBucketLockFree(nextIndex);
+				return nextIndex;
+			}
+		}
+
+		// We are full. Elements that are counted but not yet linked in (or popped but not yet
+		// uncounted) will show up shortly, so only give up if nothing is free at all.
+		if (totalFreeListSize.load(std::memory_order_relaxed) == 0) { return PtrType::NULL_PTR; }
+	}
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PopFreeListLockFree() -> IndexType
+{
+	auto &nonEmptyFreeLists(globalState_.nonEmptyFreeLists_);
+	const std::atomic_ref totalFreeListSize(globalState_.totalFreeListSize_);
+
+	// Keep looking past stale bits while other lists still hold elements, or the caller would
+	// grow the pool (which LockFree never shrinks) with free elements sat on other lists
+	IndexType ptr(PtrType::NULL_PTR);
+	std::size_t bucketNum(nonEmptyFreeLists.FindFirst());
+	while (bucketNum != HierarchicalBitmap<>::NONE) {
+		ptr = PopFreeListLockFree(bucketNum);
+		if (ptr != PtrType::NULL_PTR) { break; }
+
+		// Pops don't clear the bit when they empty a list, so we tidy up the stale bit here. Put
+		// it back if someone pushed after we looked, or they could be relying on our bit.
+		// Each side stores then loads what the other stored, which acquire/release doesn't order,
+		// so the clear, the push's CAS and both loads are seq_cst. Otherwise a pusher and we could
+		// each miss the other's store and leave a non empty list with no bit.
+		nonEmptyFreeLists.Clear(bucketNum);
+		std::atomic_ref head(globalState_.freeLists_[bucketNum].freeList_);
+		if (head.load(std::memory_order_seq_cst).ptr_ != PtrType::NULL_PTR) {
+			nonEmptyFreeLists.Set(bucketNum);
+		}
+
+		if (totalFreeListSize.load(std::memory_order_relaxed) == 0) { break; }
+		bucketNum = nonEmptyFreeLists.FindFirst();
+	}
+
+	return ptr;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PopFreeListLockFree(std::size_t bucketNum)
+		-> IndexType
+{
+	static_assert(std::atomic_ref<TaggedPtr>::is_always_lock_free &&
+						  std::atomic_ref<TaggedPtr>::required_alignment <= alignof(TaggedPtr),
+				  "LockFree needs a lock free 64 bit CAS");
+
+	auto &freeList(globalState_.freeLists_[bucketNum]);
+	std::atomic_ref head(freeList.freeList_);
+	std::atomic_ref freeListSize(freeList.freeListSize_);
+	std::atomic_ref totalFreeListSize(globalState_.totalFreeListSize_);
+
+	TaggedPtr current(head.load(std::memory_order_acquire));
+	while (current.ptr_ != PtrType::NULL_PTR) {
+		// If someone else pops current before us this may read part of their object rather than a
+		// link, but then the generation will have moved on and our CAS fails.
+		auto &link(LinkOf(current.ptr_));
+		const IndexType next(std::atomic_ref<IndexType>(link).load(std::memory_order_relaxed));
+
+		if (head.compare_exchange_weak(current, TaggedPtr{next, current.generation_ + 1},
+									   std::memory_order_acquire, std::memory_order_acquire)) {
+			freeListSize.fetch_sub(1, std::memory_order_relaxed);
+			totalFreeListSize.fetch_sub(1, std::memory_order_relaxed);
+			CountStat(&ThreadStats::freeListPops_);
+			return current.ptr_;
+		}
+	}
+
+	return PtrType::NULL_PTR;
+}
+
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::PushFreeListLockFree(IndexType ptr) -> void
+{
+	HGALLOC_ASSERT(ptr != PtrType::NULL_PTR);
+	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
+	auto &freeList(globalState_.freeLists_[bucketNum]);
+
+	std::atomic_ref totalFreeListSize(globalState_.totalFreeListSize_);
+	std::atomic_ref freeListSize(freeList.freeListSize_);
+
+	// Count it before it is visible so the total never drops below what is really on the lists
+	totalFreeListSize.fetch_add(1, std::memory_order_relaxed);
+	freeListSize.fetch_add(1, std::memory_order_relaxed);
+
+	std::atomic_ref head(freeList.freeList_);
+	std::atomic_ref link(LinkOf(ptr));
+
+	TaggedPtr current(head.load(std::memory_order_relaxed));
+	do {
+		link.store(current.ptr_, std::memory_order_relaxed);
+	} while (!head.compare_exchange_weak(current, TaggedPtr{ptr, current.generation_ + 1},
+										 std::memory_order_seq_cst, std::memory_order_relaxed));
+
+	// Checking first saves an atomic RMW on every free. If the bit is cleared after we look then
+	// whoever cleared it rechecks our list, which we have already linked into. The CAS and Test
+	// are seq_cst (see PopFreeListLockFree) so that recheck sees our push, or we see their clear,
+	// on weakly ordered CPUs as well as x86.
+	auto &nonEmptyFreeLists(globalState_.nonEmptyFreeLists_);
+	if (!nonEmptyFreeLists.Test(bucketNum)) { nonEmptyFreeLists.Set(bucketNum); }
 }
 
+template<typename T, std::size_t bs, typename... Os>
+auto GrowingGlobalPoolAllocator<T, bs, Os...>::CreateBucketLockFree(IndexType ptr) -> void
+{
+	const std::size_t bucketNum(ptr >> MostSignificantBitLocation<BUCKET_MASK>());
+	auto &buckets(globalState_.buckets_);
+
+	if (buckets.IsCreated(bucketNum)) { return; }
+
+	// Anyone else who bumped into this bucket has to wait for it to exist anyway
+	std::scoped_lock lock(mutex_);
+	if (!buckets.IsCreated(bucketNum)) {
+		buckets.Create(bucketNum);
+		CountStat(&ThreadStats::bucketsCreated_);
+	}
+}
 
 }// namespace hgalloc
@@ -0,0 +1,273 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * HierarchicalBitmap.h
+ *		A bitmap that can find its lowest set bit in constant time, however many bits it has.
+ *
+ *		The bottom level is the bitmap itself, each level above has one bit per 64 bit word of the
+ *		level below which is set if that word has any bits set. So finding the first (or last) set
+ *		bit is a count trailing (or leading) zeros per level, and with 64 way fan out even 2^32
+ *		bits only needs 6 levels (11 for 2^64). Walking the set bits in order with FindNext climbs
+ *		only as far as it needs to skip an empty stretch, so sparse bitmaps are walked in time
+ *		proportional to the bits set rather than the size.
+ *
+ *		If concurrent is true every word is updated atomically and concurrent Set/Clear calls never
+ *		lose a bit. FindFirst may return NONE if it races with a Clear, so callers should treat it
+ *		as a hint and retry.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace hgalloc {
+
+template<bool concurrent = false>
+class HierarchicalBitmap {
+public:
+	HierarchicalBitmap() = default;
+	explicit HierarchicalBitmap(std::size_t numOfBits);
+
+	auto Set(std::size_t bit) -> void;
+	auto Clear(std::size_t bit) -> void;
+	[[nodiscard]] auto Test(std::size_t bit) const -> bool;
+
+	// Returns the lowest set bit, or NONE if no bits are set
+	[[nodiscard]] auto FindFirst() const -> std::size_t;
+	// Returns the highest set bit, or NONE if no bits are set
+	[[nodiscard]] auto FindLast() const -> std::size_t;
+	// Returns the lowest set bit at or above from, or NONE if there isn't one
+	[[nodiscard]] auto FindNext(std::size_t from) const -> std::size_t;
+	// The 64 bits around bit, so callers can walk a word's bits themselves. Bit 0 of the result
+	// is bit (bit & ~63)
+	[[nodiscard]] auto WordContaining(std::size_t bit) const -> std::uint64_t;
+
+	[[nodiscard]] auto Size() const -> std::size_t;
+
+	static constexpr std::size_t NONE{std::numeric_limits<std::size_t>::max()};
+
+private:
+	using Word = std::uint64_t;
+	static constexpr std::size_t BITS_PER_WORD{std::numeric_limits<Word>::digits};
+	static constexpr std::size_t WORD_SHIFT{6};
+	static constexpr std::size_t WORD_MASK{BITS_PER_WORD - 1};
+	// 64^11 > 2^64, enough for every bit an EightByteHandles pool's TrackLiveObjects can need
+	static constexpr std::size_t MAX_LEVELS{11};
+
+	static_assert(std::size_t{1} << WORD_SHIFT == BITS_PER_WORD);
+	static_assert(WORD_SHIFT * MAX_LEVELS >= std::numeric_limits<std::size_t>::digits);
+
+	auto SetAt(std::size_t level, std::size_t bit) -> void;
+	auto ClearAt(std::size_t level, std::size_t bit) -> void;
+	[[nodiscard]] auto WordAt(std::size_t level, std::size_t bit) const -> const Word &;
+	[[nodiscard]] auto WordAt(std::size_t level, std::size_t bit) -> Word &;
+	[[nodiscard]] auto WordsInLevel(std::size_t level) const -> std::size_t;
+
+	static auto Load(const Word &) -> Word;
+	// Both return the value the word had before
+	static auto Or(Word &, Word mask) -> Word;
+	static auto And(Word &, Word mask) -> Word;
+
+	// Every level stored back to back, bottom level first
+	std::vector<Word> words_;
+	std::array<std::size_t, MAX_LEVELS> levelOffsets_{};
+	std::size_t numOfLevels_{0};
+	std::size_t numOfBits_{0};
+};
+
+template<bool concurrent>
+HierarchicalBitmap<concurrent>::HierarchicalBitmap(std::size_t numOfBits) : numOfBits_(numOfBits)
+{
+	if (numOfBits == 0) { return; }
+
+	std::size_t bitsInLevel(numOfBits);
+	std::size_t totalWords(0);
+	do {
+		const std::size_t wordsInLevel((bitsInLevel + BITS_PER_WORD - 1) / BITS_PER_WORD);
+		levelOffsets_[numOfLevels_++] = totalWords;
+		totalWords += wordsInLevel;
+		bitsInLevel = wordsInLevel;
+	} while (bitsInLevel > 1);
+
+	words_.resize(totalWords);
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Set(std::size_t bit) -> void
+{
+	SetAt(0, bit);
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Clear(std::size_t bit) -> void
+{
+	ClearAt(0, bit);
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Test(std::size_t bit) const -> bool
+{
+	return (Load(WordAt(0, bit)) >> (bit & WORD_MASK)) & 1;
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::FindFirst() const -> std::size_t
+{
+	if (numOfLevels_ == 0) { return NONE; }
+
+	std::size_t bit(0);
+	for (std::size_t level(numOfLevels_); level-- > 0;) {
+		const Word word(Load(words_[levelOffsets_[level] + bit]));
+		if (word == 0) { return NONE; }
+		bit = (bit << WORD_SHIFT) + static_cast<std::size_t>(std::countr_zero(word));
+	}
+	return bit;
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::FindLast() const -> std::size_t
+{
+	if (numOfLevels_ == 0) { return NONE; }
+
+	std::size_t bit(0);
+	for (std::size_t level(numOfLevels_); level-- > 0;) {
+		const Word word(Load(words_[levelOffsets_[level] + bit]));
+		if (word == 0) { return NONE; }
+		const auto highest(BITS_PER_WORD - 1 - static_cast<std::size_t>(std::countl_zero(word)));
+		bit = (bit << WORD_SHIFT) + highest;
+	}
+	return bit;
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::FindNext(std::size_t from) const -> std::size_t
+{
+	if (from >= numOfBits_) { return NONE; }
+
+	// Climb until a word has a bit at or after ours, then descend to its lowest set bit
+	std::size_t bit(from);
+	for (std::size_t level(0); level < numOfLevels_; ++level) {
+		const Word word(Load(WordAt(level, bit)) & (~Word{0} << (bit & WORD_MASK)));
+		if (word != 0) {
+			bit = (bit & ~WORD_MASK) + static_cast<std::size_t>(std::countr_zero(word));
+			while (level-- > 0) {
+				const Word below(Load(words_[levelOffsets_[level] + bit]));
+				// Lost a race with a Clear
+				if (below == 0) { return NONE; }
+				bit = (bit << WORD_SHIFT) + static_cast<std::size_t>(std::countr_zero(below));
+			}
+			return bit;
+		}
+
+		// Nothing left in this word, carry on from the next word's bit in the level above
+		bit = (bit >> WORD_SHIFT) + 1;
+		if (bit >= WordsInLevel(level)) { return NONE; }
+	}
+	return NONE;
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::WordContaining(std::size_t bit) const -> std::uint64_t
+{
+	return Load(WordAt(0, bit));
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Size() const -> std::size_t
+{
+	return numOfBits_;
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::SetAt(std::size_t level, std::size_t bit) -> void
+{
+	for (; level < numOfLevels_; ++level, bit >>= WORD_SHIFT) {
+		// If the word already had a bit set the levels above already know about it
+		if (Or(WordAt(level, bit), Word{1} << (bit & WORD_MASK)) != 0) { return; }
+	}
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::ClearAt(std::size_t level, std::size_t bit) -> void
+{
+	auto &word(WordAt(level, bit));
+	const Word mask(Word{1} << (bit & WORD_MASK));
+	const Word before(And(word, ~mask));
+
+	if ((before & ~mask) != 0 || level + 1 == numOfLevels_) { return; }
+
+	// Word is now empty, so clear our bit in the level above
+	ClearAt(level + 1, bit >> WORD_SHIFT);
+
+	// Someone may have set a bit in our word after we emptied it but before we cleared the level
+	// above, in which case put the level above back
+	if constexpr (concurrent) {
+		if (Load(word) != 0) { SetAt(level + 1, bit >> WORD_SHIFT); }
+	}
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::WordAt(std::size_t level, std::size_t bit) const
+		-> const Word &
+{
+	return words_[levelOffsets_[level] + (bit >> WORD_SHIFT)];
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::WordAt(std::size_t level, std::size_t bit) -> Word &
+{
+	return words_[levelOffsets_[level] + (bit >> WORD_SHIFT)];
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::WordsInLevel(std::size_t level) const -> std::size_t
+{
+	const std::size_t end(level + 1 < numOfLevels_ ? levelOffsets_[level + 1] : words_.size());
+	return end - levelOffsets_[level];
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Load(const Word &word) -> Word
+{
+	if constexpr (concurrent) {
+		// seq_cst like Or and And, so a Set or Clear then a load of another variable can't be
+		// reordered against a caller doing the reverse. It costs the same as acquire on x86/ARMv8.
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast) - atomic_ref needs non const
+		return std::atomic_ref<Word>(const_cast<Word &>(word)).load(std::memory_order_seq_cst);
+	} else {
+		return word;
+	}
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::Or(Word &word, Word mask) -> Word
+{
+	if constexpr (concurrent) {
+		return std::atomic_ref<Word>(word).fetch_or(mask);
+	} else {
+		const Word before(word);
+		word |= mask;
+		return before;
+	}
+}
+
+template<bool concurrent>
+auto HierarchicalBitmap<concurrent>::And(Word &word, Word mask) -> Word
+{
+	if constexpr (concurrent) {
+		return std::atomic_ref<Word>(word).fetch_and(mask);
+	} else {
+		const Word before(word);
+		word &= mask;
+		return before;
+	}
+}
+
+}// namespace hgalloc
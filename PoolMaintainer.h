@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * PoolMaintainer.h
+ *		Runs a pool's Maintain() on a background thread every <interval> until it goes out of scope,
+ *		so bucket creation and freeing happen off the threads using the pool. e.g.
+ *
+ *			GrowingGlobalPoolAllocator<Order, 16'384, LockFree, DeferredMaintenance> pool{n};
+ *			PoolMaintainer maintainer{pool, std::chrono::milliseconds(1)};
+ *
+ *		Must be destroyed before the pool. Maintain() takes the pool's lock, so this can't be used
+ *		with SingleThreaded pools.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "PoolOptions.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+
+namespace hgalloc {
+
+template<typename Allocator>
+class PoolMaintainer {
+public:
+	static_assert(!std::is_same_v<typename Allocator::Threading::Mutex, NullMutex>,
+				  "SingleThreaded pools must call Maintain() themselves");
+
+	template<typename Rep, typename Period>
+	PoolMaintainer(Allocator &allocator, std::chrono::duration<Rep, Period> interval);
+	~PoolMaintainer() = default;
+
+	PoolMaintainer(PoolMaintainer &&) = delete;
+	PoolMaintainer &operator=(PoolMaintainer &&) = delete;
+	PoolMaintainer(const PoolMaintainer &) = delete;
+	PoolMaintainer &operator=(const PoolMaintainer &) = delete;
+
+private:
+	std::mutex mutex_;
+	std::condition_variable_any wakeUp_;
+	// Last so it is stopped and joined before the rest of us is destroyed
+	std::jthread thread_;
+};
+
+template<typename Allocator>
+template<typename Rep, typename Period>
+PoolMaintainer<Allocator>::PoolMaintainer(Allocator &allocator,
+										  std::chrono::duration<Rep, Period> interval)
+	: thread_([this, &allocator, interval](std::stop_token stop) {
+		  std::unique_lock lock(mutex_);
+		  while (!stop.stop_requested()) {
+			  allocator.Maintain();
+			  wakeUp_.wait_for(lock, stop, interval, [] { return false; });
+		  }
+	  })
+{
+}
+
+}// namespace hgalloc
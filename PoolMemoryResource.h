@@ -0,0 +1,127 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * PoolMemoryResource.h
+ *		A std::pmr::memory_resource that hands out blocks of up to blockSize bytes from a growing
+ *		pool, so pmr containers of small nodes (list, map, unordered_map) get the pool's memory
+ *		behaviour without knowing about FourBytePtr. e.g.
+ *
+ *			PoolMemoryResource<64, 16'384> resource{1'000'000};
+ *			std::pmr::map<int, int> map{&resource};
+ *
+ *		Anything bigger, more aligned or allocated once the pool is full goes to upstream. The
+ *		pointer is mapped back to its index on deallocate with one subtract and divide, so the
+ *		pool must use a reserved storage (the default here) rather than HeapBuckets.
+ *
+ *		Like the pool itself only one resource of each type can exist at a time, pass a PoolTag
+ *		to have more.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace hgalloc {
+
+template<std::size_t blockSize, std::size_t bucketSize, typename... Options>
+class PoolMemoryResource : public std::pmr::memory_resource {
+public:
+	static constexpr std::size_t BLOCK_ALIGNMENT{alignof(std::max_align_t)};
+
+	using Block = detail::RawNode<blockSize, BLOCK_ALIGNMENT, PoolMemoryResource>;
+
+	// ReservedAddressSpace goes last so it is only the default
+	using Allocator =
+			GrowingGlobalPoolAllocator<Block, bucketSize, Options..., ReservedAddressSpace>;
+
+	explicit PoolMemoryResource(
+			std::size_t maxBlocks,
+			std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+	~PoolMemoryResource() override = default;
+
+	PoolMemoryResource(PoolMemoryResource &&) = delete;
+	PoolMemoryResource &operator=(PoolMemoryResource &&) = delete;
+	PoolMemoryResource(const PoolMemoryResource &) = delete;
+	PoolMemoryResource &operator=(const PoolMemoryResource &) = delete;
+
+	[[nodiscard]] auto Pool() -> Allocator &;
+	[[nodiscard]] auto Upstream() const -> std::pmr::memory_resource *;
+
+private:
+	static constexpr auto FitsInBlock(std::size_t bytes, std::size_t alignment) -> bool;
+
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override;
+	auto do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) -> void override;
+	[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &rhs) const noexcept
+			-> bool override;
+
+	Allocator pool_;
+	std::pmr::memory_resource *upstream_;
+};
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+PoolMemoryResource<blockSize, bs, Os...>::PoolMemoryResource(std::size_t maxBlocks,
+															  std::pmr::memory_resource *upstream)
+	: pool_(maxBlocks), upstream_(upstream)
+{
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+auto PoolMemoryResource<blockSize, bs, Os...>::Pool() -> Allocator &
+{
+	return pool_;
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+auto PoolMemoryResource<blockSize, bs, Os...>::Upstream() const -> std::pmr::memory_resource *
+{
+	return upstream_;
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+constexpr auto PoolMemoryResource<blockSize, bs, Os...>::FitsInBlock(std::size_t bytes,
+																	 std::size_t alignment) -> bool
+{
+	return bytes <= blockSize && alignment <= BLOCK_ALIGNMENT;
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+auto PoolMemoryResource<blockSize, bs, Os...>::do_allocate(std::size_t bytes, std::size_t alignment)
+		-> void *
+{
+	if (FitsInBlock(bytes, alignment)) {
+		auto ptr(pool_.Allocate());
+		// The handle gives up ownership, do_deallocate reclaims it from the address
+		if (nullptr != ptr) {
+			void *block(ptr.get());
+			ptr.release();
+			return block;
+		}
+	}
+	return upstream_->allocate(bytes, alignment);
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+auto PoolMemoryResource<blockSize, bs, Os...>::do_deallocate(void *ptr, std::size_t bytes,
+															 std::size_t alignment) -> void
+{
+	// A small allocation can still be upstream's if the pool was full at the time
+	if (FitsInBlock(bytes, alignment) && Allocator::Contains(ptr)) {
+		Allocator::FreeIndex(Allocator::IndexOf(static_cast<Block *>(ptr)));
+		return;
+	}
+	upstream_->deallocate(ptr, bytes, alignment);
+}
+
+template<std::size_t blockSize, std::size_t bs, typename... Os>
+auto PoolMemoryResource<blockSize, bs, Os...>::do_is_equal(
+		const std::pmr::memory_resource &rhs) const noexcept -> bool
+{
+	return this == &rhs;
+}
+
+}// namespace hgalloc
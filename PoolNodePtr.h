@@ -0,0 +1,197 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * PoolNodePtr.h
+ *		A non-owning fancy pointer to an element of a pool that is just its 4 byte index, for
+ *		allocators whose pointer type containers store as their links (see
+ *		CompactPoolStlAllocator). Dereferencing it is the same bucket lookup as a handle.
+ *
+ *		It meets the allocator pointer requirements: nullable, converts to pointers to const and
+ *		void and back with static_cast, and pointer_traits::pointer_to finds the index from an
+ *		address. Arithmetic is on the index, so is only meaningful within a bucket, which is all
+ *		a container of single nodes needs.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+namespace hgalloc {
+
+// Pool is the GrowingGlobalPoolAllocator the index is into, its elements are reinterpreted as T
+template<typename T, typename Pool>
+class PoolNodePtr {
+public:
+	using element_type = T;
+	using value_type = std::remove_cv_t<T>;
+	using difference_type = std::ptrdiff_t;
+	using reference = std::add_lvalue_reference_t<T>;
+	using pointer = PoolNodePtr;
+	using iterator_category = std::random_access_iterator_tag;
+
+	static constexpr FourBytePtr NULL_PTR{std::numeric_limits<FourBytePtr>::max()};
+
+	PoolNodePtr() = default;
+	// NOLINTNEXTLINE(google-explicit-constructor) - has to convert like nullptr does
+	PoolNodePtr(std::nullptr_t) {}
+	explicit PoolNodePtr(FourBytePtr index) : index_(index) {}
+
+	// Implicit to pointers to const and void, like T * is
+	template<typename U>
+	requires std::is_convertible_v<U *, T *>
+	// NOLINTNEXTLINE(google-explicit-constructor)
+	PoolNodePtr(const PoolNodePtr<U, Pool> &rhs) : index_(rhs.Index())
+	{
+	}
+
+	// static_cast back from void, or between related types
+	template<typename U>
+	requires(!std::is_convertible_v<U *, T *> &&
+			 requires(U *u) { static_cast<T *>(u); })
+	explicit PoolNodePtr(const PoolNodePtr<U, Pool> &rhs) : index_(rhs.Index())
+	{
+	}
+
+	// A template as there's no reference to void
+	template<typename U = T>
+	requires(!std::is_void_v<U>)
+	static auto pointer_to(U &element) -> PoolNodePtr;
+
+	[[nodiscard]] auto Index() const -> FourBytePtr;
+	[[nodiscard]] auto get() const -> T *;
+
+	auto operator*() const -> reference
+	requires(!std::is_void_v<T>);
+	auto operator->() const -> T *;
+	auto operator[](difference_type n) const -> reference
+	requires(!std::is_void_v<T>);
+
+	explicit operator bool() const;
+
+	auto operator++() -> PoolNodePtr &;
+	auto operator++(int) -> PoolNodePtr;
+	auto operator--() -> PoolNodePtr &;
+	auto operator--(int) -> PoolNodePtr;
+	auto operator+=(difference_type n) -> PoolNodePtr &;
+	auto operator-=(difference_type n) -> PoolNodePtr &;
+
+	friend auto operator+(PoolNodePtr ptr, difference_type n) -> PoolNodePtr { return ptr += n; }
+	friend auto operator+(difference_type n, PoolNodePtr ptr) -> PoolNodePtr { return ptr += n; }
+	friend auto operator-(PoolNodePtr ptr, difference_type n) -> PoolNodePtr { return ptr -= n; }
+	friend auto operator-(PoolNodePtr lhs, PoolNodePtr rhs) -> difference_type
+	{
+		return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+	}
+
+	friend auto operator==(PoolNodePtr lhs, PoolNodePtr rhs) -> bool = default;
+	friend auto operator<=>(PoolNodePtr lhs, PoolNodePtr rhs) -> std::strong_ordering = default;
+	friend auto operator==(PoolNodePtr lhs, std::nullptr_t) -> bool
+	{
+		return lhs.index_ == NULL_PTR;
+	}
+
+private:
+	FourBytePtr index_{NULL_PTR};
+};
+
+template<typename T, typename Pool>
+template<typename U>
+requires(!std::is_void_v<U>)
+auto PoolNodePtr<T, Pool>::pointer_to(U &element) -> PoolNodePtr
+{
+	using Element = typename Pool::Type;
+	const auto *address(static_cast<const void *>(std::addressof(element)));
+	const FourBytePtr index(Pool::IndexOf(static_cast<const Element *>(address)));
+	HGALLOC_ASSERT(static_cast<const void *>(Pool::AddressOf(index)) == address);
+	return PoolNodePtr{index};
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::Index() const -> FourBytePtr
+{
+	return index_;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::get() const -> T *
+{
+	if (index_ == NULL_PTR) { return nullptr; }
+	return static_cast<T *>(static_cast<void *>(Pool::AddressOf(index_)));
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator*() const -> reference
+requires(!std::is_void_v<T>)
+{
+	return *get();
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator->() const -> T *
+{
+	return get();
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator[](difference_type n) const -> reference
+requires(!std::is_void_v<T>)
+{
+	return *(*this + n);
+}
+
+template<typename T, typename Pool>
+PoolNodePtr<T, Pool>::operator bool() const
+{
+	return index_ != NULL_PTR;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator++() -> PoolNodePtr &
+{
+	return *this += 1;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator++(int) -> PoolNodePtr
+{
+	const PoolNodePtr ret(*this);
+	++*this;
+	return ret;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator--() -> PoolNodePtr &
+{
+	return *this -= 1;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator--(int) -> PoolNodePtr
+{
+	const PoolNodePtr ret(*this);
+	--*this;
+	return ret;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator+=(difference_type n) -> PoolNodePtr &
+{
+	index_ = static_cast<FourBytePtr>(static_cast<difference_type>(index_) + n);
+	return *this;
+}
+
+template<typename T, typename Pool>
+auto PoolNodePtr<T, Pool>::operator-=(difference_type n) -> PoolNodePtr &
+{
+	return *this += -n;
+}
+
+}// namespace hgalloc
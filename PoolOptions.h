@@ -0,0 +1,349 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * PoolOptions.h
+ *		Options that can be passed to GrowingGlobalPoolAllocator after the bucket size to change how it
+ *		behaves. Each option belongs to a category (threading etc), you can pass them in any order
+ *		and anything you don't pass falls back to the default for that category, e.g.
+ *
+ *			GrowingGlobalPoolAllocator<Session, 16'384, ThreadCached<64>>
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+namespace hgalloc {
+
+// Every option derives from this (via its category) so we can catch typos at compile time
+struct PoolOption {
+};
+
+namespace detail {
+
+template<typename Category, typename Default, typename... Options>
+struct SelectOptionImpl {
+	using Type = Default;
+};
+
+template<typename Category, typename Default, typename Option, typename... Options>
+struct SelectOptionImpl<Category, Default, Option, Options...> {
+	static_assert(std::is_base_of_v<PoolOption, Option>, "Unknown pool option");
+
+	using Type = std::conditional_t<std::is_base_of_v<Category, Option>, Option,
+									typename SelectOptionImpl<Category, Default, Options...>::Type>;
+};
+
+}// namespace detail
+
+// Picks the first option in Options that belongs to Category, or Default if there isn't one
+template<typename Category, typename Default, typename... Options>
+using SelectOption = typename detail::SelectOptionImpl<Category, Default, Options...>::Type;
+
+/*
+ * Threading
+ */
+struct ThreadingOption : PoolOption {
+};
+
+// Lock that does nothing, used so single threaded pools pay nothing for the locking code
+struct NullMutex {
+	auto lock() -> void {}
+	auto unlock() -> void {}
+};
+
+// The default. No synchronisation at all, every call must come from the same thread (or be
+// externally synchronised).
+struct SingleThreaded : ThreadingOption {
+	using Mutex = NullMutex;
+	static constexpr std::size_t magazineSize{0};
+	static constexpr bool lockFree{false};
+};
+
+// Each thread keeps two magazines of up to <magazineSize> free pointers. Allocate and Free only
+// touch the magazines, the shared free lists are only locked to refill an empty magazine or drain
+// a full one, so we take the lock at most once every <magazineSize> calls.
+//
+// Elements sitting in another thread's magazine can't be handed out, so a pool that is nearly full
+// can return nullptr slightly before it is completely full.
+template<std::size_t size>
+struct ThreadCached : ThreadingOption {
+	static_assert(size > 0, "magazineSize cannot be zero");
+
+	using Mutex = std::mutex;
+	static constexpr std::size_t magazineSize{size};
+	static constexpr bool lockFree{false};
+};
+
+// Allocate and Free never block. The free lists are Treiber stacks whose head is a 32 bit pointer
+// plus a 32 bit generation updated with a single 64 bit CAS, so any thread can free an element
+// allocated by any other. Creating a new bucket still takes a lock, but that only happens once
+// every <bucketSize> allocations and is dominated by the allocation of the bucket itself.
+//
+// Another thread may be reading a free list link out of any free element at any time, so buckets
+// are never evicted. The pool grows to its high water mark and stays there.
+struct LockFree : ThreadingOption {
+	using Mutex = std::mutex;
+	static constexpr std::size_t magazineSize{0};
+	static constexpr bool lockFree{true};
+};
+
+/*
+ * Maintenance
+ */
+struct MaintenanceOption : PoolOption {
+};
+
+// The default. Evicted buckets are freed straight away by whichever call evicted them.
+struct InlineMaintenance : MaintenanceOption {
+	static constexpr bool deferred{false};
+};
+
+// Evicted buckets are kept until the next Maintain() call frees them, so Free never has to give
+// megabytes back to the OS. Call Maintain() regularly from somewhere off the hot path (or use a
+// PoolMaintainer for ThreadCached and LockFree pools). It also creates and faults in the bucket
+// the pool will grow into next, so growing doesn't take the page faults either.
+struct DeferredMaintenance : MaintenanceOption {
+	static constexpr bool deferred{true};
+};
+
+/*
+ * Eviction
+ *
+ * When to give a fully free bucket back. Only called from Free (and Maintain() for IdleEviction),
+ * and LockFree pools never evict whichever policy they are given.
+ */
+struct EvictionOption : PoolOption {
+};
+
+enum class EvictionKind { HighestBucket, Watermarks, Idle, AnyBucket };
+
+// The default. Every <bucketSize> frees, if more than one and a half buckets worth of elements are
+// free, evicts the top buckets for as long as they are completely free.
+struct HighestBucketEviction : EvictionOption {
+	static constexpr EvictionKind kind{EvictionKind::HighestBucket};
+};
+
+// Checked on every free. Once more than <highFreeBuckets> buckets worth of elements are free,
+// evicts the top buckets until no more than <lowFreeBuckets> worth are free or the top bucket is
+// in use. The gap between the two stops a pool hovering around one watermark from thrashing.
+template<std::size_t highFreeBuckets, std::size_t lowFreeBuckets>
+struct WatermarkEviction : EvictionOption {
+	static_assert(lowFreeBuckets < highFreeBuckets, "The low watermark must be below the high one");
+
+	static constexpr EvictionKind kind{EvictionKind::Watermarks};
+	static constexpr std::size_t highWatermark{highFreeBuckets};
+	static constexpr std::size_t lowWatermark{lowFreeBuckets};
+};
+
+// Evicts the top bucket once it has been completely free for <idleMilliseconds>, however many
+// other elements are free, then starts timing the bucket below it. Checked every <bucketSize>
+// frees and on every Maintain(), so a pool that goes quiet only decays if Maintain() is called
+// (which doesn't fault in a spare bucket for these pools).
+// A bucket counts as idle if it was free every time we checked, we don't notice it being used
+// and freed again in between.
+template<std::size_t idleMilliseconds>
+struct IdleEviction : EvictionOption {
+	static constexpr EvictionKind kind{EvictionKind::Idle};
+	static constexpr std::chrono::milliseconds idleTime{idleMilliseconds};
+};
+
+// Like HighestBucketEviction but releases any completely free bucket, highest first, not just the
+// ones on top. A released bucket in the middle of the pool is handed out again a bump at a time
+// before we grow, and its memory is only recreated when it is. So a pool whose long lived elements
+// pin a few high buckets still gives back the holes below them. Costs a bit test on every free
+// and an extra 8 bytes per bucket.
+struct AnyBucketEviction : EvictionOption {
+	static constexpr EvictionKind kind{EvictionKind::AnyBucket};
+};
+
+/*
+ * Stats
+ */
+struct StatsOption : PoolOption {
+};
+
+// The default. Nothing is counted and GetStats() doesn't compile.
+struct NoStats : StatsOption {
+	static constexpr bool enabled{false};
+};
+
+// Each thread counts what it does in its own counters, which GetStats() adds up, so counting never
+// contends. Costs a thread local lookup and a few uncontended stores per Allocate and Free.
+struct CollectStats : StatsOption {
+	static constexpr bool enabled{true};
+};
+
+/*
+ * Live tracking
+ */
+struct LiveTrackingOption : PoolOption {
+};
+
+// The default. ForEachLive() and LiveObjects() don't compile.
+struct NoLiveTracking : LiveTrackingOption {
+	static constexpr bool enabled{false};
+};
+
+// Keeps a hierarchical bitmap with a bit per element, set while it is live, so ForEachLive() and
+// LiveObjects() can walk the live elements in memory order and skip free stretches a word (or a
+// whole summary word) at a time. Costs maxElements / 8 bytes and a bit set and clear per Allocate
+// and Free, atomic if the pool is thread safe.
+struct TrackLiveObjects : LiveTrackingOption {
+	static constexpr bool enabled{true};
+};
+
+/*
+ * Generations
+ */
+struct GenerationOption : PoolOption {
+};
+
+// The default. Handles are plain indices and FourByteWeakPtr doesn't compile.
+struct NoGenerations : GenerationOption {
+	static constexpr std::size_t bits{0};
+};
+
+// Keeps a counter per element that is bumped every time it is freed, and a FourByteWeakPtr keeps
+// the low generationBits bits of it in its top bits. So lock() is one compare, and a weak handle
+// to a freed element stays expired until that element has been freed another 2^generationBits
+// times. The index gets the other 32 - generationBits bits, which limits maxElements. Costs the
+// smallest of 1, 2 or 4 bytes an element that fits, kept for the life of the pool so generations
+// survive their bucket being evicted.
+template<std::size_t generationBits>
+struct Generations : GenerationOption {
+	static_assert(generationBits > 0 && generationBits < 32,
+				  "Needs at least one bit each for the generation and the index");
+	static constexpr std::size_t bits{generationBits};
+};
+
+/*
+ * Handles
+ */
+struct HandleOption : PoolOption {
+};
+
+// The unsigned integer handles hold. A pool can hold one fewer element than the integer has
+// values, as all bits set is the null handle. Smaller handles halve the size of structures full
+// of them, bigger ones let a pool hold more than 4 billion elements.
+template<typename UInt>
+struct HandleType : HandleOption {
+	static_assert(std::is_unsigned_v<UInt>, "Handles must be unsigned integers");
+	using Type = UInt;
+};
+
+// The default
+using FourByteHandles = HandleType<std::uint32_t>;
+// Up to 65,535 elements
+using TwoByteHandles = HandleType<std::uint16_t>;
+using EightByteHandles = HandleType<std::uint64_t>;
+
+/*
+ * Reference counting
+ */
+struct RefCountOption : PoolOption {
+};
+
+// The default. AllocateShared() and Share() don't compile.
+struct NoRefCounts : RefCountOption {
+	static constexpr bool enabled{false};
+	static constexpr bool atomic{false};
+};
+
+// Keeps a 4 byte reference count per element in an array beside each bucket, so elements can be
+// owned by any number of FourByteSharedPtrs. Counts start at zero when a bucket is created and
+// only handles made by AllocateShared() or Share() use them. Compact() doesn't compile as it can't
+// hand a moved element to every owner. RefCounted counts are plain integers, so every copy of a
+// handle has to stay on one thread at a time, AtomicRefCounted ones can be shared between threads
+// of a thread safe pool like std::shared_ptr.
+struct RefCounted : RefCountOption {
+	static constexpr bool enabled{true};
+	static constexpr bool atomic{false};
+};
+
+struct AtomicRefCounted : RefCountOption {
+	static constexpr bool enabled{true};
+	static constexpr bool atomic{true};
+};
+
+/*
+ * Layout
+ *
+ * How elements are laid out in a bucket. Block<T> is what the buckets are arrays of, and
+ * outOfBandLinks says whether free list links live in a separate array rather than in the free
+ * elements themselves.
+ */
+struct LayoutOption : PoolOption {
+};
+
+// The default. Elements are sizeof(T) apart and aligned to alignof(T), and a free element holds
+// its free list link, so T must be at least as big as the pool's handles (4 bytes by default).
+struct NaturalLayout : LayoutOption {
+	static constexpr bool outOfBandLinks{false};
+
+	template<typename T>
+	struct alignas(T) Block {
+		std::array<char, sizeof(T)> buf;
+	};
+};
+
+// Every element gets cache lines of its own, so elements written by different threads never
+// falsely share a line. Costs the padding up to the next multiple of 64 bytes per element.
+struct CacheLinePadded : LayoutOption {
+	static constexpr std::size_t CACHE_LINE_SIZE{64};
+	static constexpr bool outOfBandLinks{false};
+
+	template<typename T>
+	struct alignas(std::max(CACHE_LINE_SIZE, alignof(T))) Block {
+		std::array<char, sizeof(T)> buf;
+	};
+};
+
+// For types smaller than a link (bools, chars, shorts). Elements are laid out as NaturalLayout,
+// and each bucket gets a parallel array of links, as wide as the pool's handles, for its free
+// list. So with the default 4 byte handles a 1 byte T costs 5 bytes rather than being padded out
+// to 8.
+struct PackedLayout : LayoutOption {
+	static constexpr bool outOfBandLinks{true};
+
+	template<typename T>
+	struct alignas(T) Block {
+		std::array<char, sizeof(T)> buf;
+	};
+};
+
+/*
+ * Pool identity
+ */
+struct PoolIdentityOption : PoolOption {
+};
+
+// The default, one pool per <T, bucketSize, Options...>
+struct Untagged : PoolIdentityOption {
+};
+
+// All of a pool's state is static so its handles can be 4 bytes, which means there can only be one
+// pool of each type at a time. Tagging a pool makes it a different type with its own state, so you
+// can give each shard, tenant or NUMA node a pool of its own, e.g.
+//
+//		struct OrdersShard;
+//		GrowingGlobalPoolAllocator<Order, 16'384, PoolTag<OrdersShard>> orders{1'000'000};
+//
+// Handles from different pools are different types, so you can't free into the wrong pool.
+template<typename Tag>
+struct PoolTag : PoolIdentityOption {
+	using Type = Tag;
+};
+
+// A tag that is just a number, handy for making N pools with std::index_sequence
+template<std::size_t id>
+using PoolId = PoolTag<std::integral_constant<std::size_t, id>>;
+
+}// namespace hgalloc
@@ -0,0 +1,196 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * PoolStlAllocator.h
+ *		Standard allocators that take single node allocations from a pool, so the nodes of
+ *		std::map, std::set, std::list and std::unordered_map sit together in buckets instead of
+ *		being scattered over the heap. e.g.
+ *
+ *			using Alloc = PoolStlAllocator<std::pair<const int, Order>, 1'000'000, 16'384>;
+ *			std::map<int, Order, std::less<>, Alloc> orders;
+ *
+ *		PoolStlAllocator hands out plain pointers. Arrays (a hash table's buckets, a vector) and
+ *		anything once the pool is full come from std::allocator instead, so it works with any
+ *		container.
+ *
+ *		CompactPoolStlAllocator's pointer type is a 4 byte PoolNodePtr, so containers that store
+ *		their links as allocator pointers halve the size of each link. It can only allocate single
+ *		nodes, and throws bad_alloc for arrays or when the pool is full. With libstdc++ only
+ *		std::forward_list currently accepts it; our own containers are written for it.
+ *
+ *		Both are stateless. Every allocator with the same node size and alignment, maxElements,
+ *		bucketSize and Options shares one pool, created on first use and never destroyed so that
+ *		containers with static storage duration can still free into it on exit. The pool uses
+ *		ReservedAddressSpace unless Options say otherwise, as deallocate maps the pointer back to
+ *		its index.
+ *
+ *		As unrelated containers on different threads can share a pool, the pool is ThreadCached<64>
+ *		unless Options pick another threading option. Pass SingleThreaded to drop the thread caches
+ *		if every container of that node size is only ever used from one thread.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+#include "PoolNodePtr.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace hgalloc {
+
+namespace detail {
+
+// Keyed on the node's size and alignment rather than its type, so there's one pool per Node.
+// maxElements is part of the Node type too so allocators with different limits don't try to
+// create the same pool.
+template<std::size_t size, std::size_t alignment, std::size_t maxElements, std::size_t bucketSize,
+		 typename... Options>
+struct StlNodePool {
+	using Node = RawNode<size, alignment, StlNodePool>;
+	// Options come first so they override the defaults
+	using Pool = GrowingGlobalPoolAllocator<Node, bucketSize, Options..., ThreadCached<64>,
+											ReservedAddressSpace>;
+
+	// Returns NULL_PTR if the pool is full
+	static auto Allocate() -> FourBytePtr;
+	static auto Free(FourBytePtr) -> void;
+	static auto Instance() -> Pool &;
+};
+
+template<std::size_t size, std::size_t alignment, std::size_t maxElements, std::size_t bs,
+		 typename... Os>
+auto StlNodePool<size, alignment, maxElements, bs, Os...>::Allocate() -> FourBytePtr
+{
+	return Instance().Allocate().release();
+}
+
+template<std::size_t size, std::size_t alignment, std::size_t maxElements, std::size_t bs,
+		 typename... Os>
+auto StlNodePool<size, alignment, maxElements, bs, Os...>::Free(FourBytePtr ptr) -> void
+{
+	Pool::FreeIndex(ptr);
+}
+
+template<std::size_t size, std::size_t alignment, std::size_t maxElements, std::size_t bs,
+		 typename... Os>
+auto StlNodePool<size, alignment, maxElements, bs, Os...>::Instance() -> Pool &
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-owning-memory) - leaked on purpose, see the header comment
+	static auto *pool(new Pool{maxElements});
+	return *pool;
+}
+
+}// namespace detail
+
+template<typename T, std::size_t maxElements, std::size_t bucketSize, typename... Options>
+class PoolStlAllocator {
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+	using NodePool =
+			detail::StlNodePool<sizeof(T), alignof(T), maxElements, bucketSize, Options...>;
+
+	template<typename U>
+	struct rebind {
+		using other = PoolStlAllocator<U, maxElements, bucketSize, Options...>;
+	};
+
+	PoolStlAllocator() = default;
+	template<typename U>
+	// NOLINTNEXTLINE(google-explicit-constructor) - containers rebind implicitly
+	PoolStlAllocator(const PoolStlAllocator<U, maxElements, bucketSize, Options...> &)
+	{
+	}
+
+	[[nodiscard]] auto allocate(std::size_t n) -> T *;
+	auto deallocate(T *ptr, std::size_t n) -> void;
+
+	template<typename U>
+	friend auto operator==(const PoolStlAllocator &,
+						   const PoolStlAllocator<U, maxElements, bucketSize, Options...> &) -> bool
+	{
+		return true;
+	}
+};
+
+template<typename T, std::size_t maxElements, std::size_t bucketSize, typename... Options>
+class CompactPoolStlAllocator {
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+	using NodePool =
+			detail::StlNodePool<sizeof(T), alignof(T), maxElements, bucketSize, Options...>;
+	using pointer = PoolNodePtr<T, typename NodePool::Pool>;
+	using const_pointer = PoolNodePtr<const T, typename NodePool::Pool>;
+	using void_pointer = PoolNodePtr<void, typename NodePool::Pool>;
+	using const_void_pointer = PoolNodePtr<const void, typename NodePool::Pool>;
+
+	template<typename U>
+	struct rebind {
+		using other = CompactPoolStlAllocator<U, maxElements, bucketSize, Options...>;
+	};
+
+	CompactPoolStlAllocator() = default;
+	template<typename U>
+	// NOLINTNEXTLINE(google-explicit-constructor) - containers rebind implicitly
+	CompactPoolStlAllocator(const CompactPoolStlAllocator<U, maxElements, bucketSize, Options...> &)
+	{
+	}
+
+	[[nodiscard]] auto allocate(std::size_t n) -> pointer;
+	auto deallocate(pointer ptr, std::size_t n) -> void;
+
+	template<typename U>
+	friend auto operator==(const CompactPoolStlAllocator &,
+						   const CompactPoolStlAllocator<U, maxElements, bucketSize, Options...> &)
+			-> bool
+	{
+		return true;
+	}
+};
+
+template<typename T, std::size_t maxElements, std::size_t bs, typename... Os>
+auto PoolStlAllocator<T, maxElements, bs, Os...>::allocate(std::size_t n) -> T *
+{
+	if (n == 1) {
+		const FourBytePtr ptr(NodePool::Allocate());
+		if (ptr != NodePool::Pool::PtrType::NULL_PTR) {
+			return reinterpret_cast<T *>(NodePool::Pool::AddressOf(ptr));
+		}
+	}
+	return std::allocator<T>{}.allocate(n);
+}
+
+template<typename T, std::size_t maxElements, std::size_t bs, typename... Os>
+auto PoolStlAllocator<T, maxElements, bs, Os...>::deallocate(T *ptr, std::size_t n) -> void
+{
+	// A single node can still be std::allocator's if the pool was full at the time
+	if (n == 1 && NodePool::Pool::Contains(ptr)) {
+		NodePool::Free(NodePool::Pool::IndexOf(reinterpret_cast<typename NodePool::Node *>(ptr)));
+		return;
+	}
+	std::allocator<T>{}.deallocate(ptr, n);
+}
+
+template<typename T, std::size_t maxElements, std::size_t bs, typename... Os>
+auto CompactPoolStlAllocator<T, maxElements, bs, Os...>::allocate(std::size_t n) -> pointer
+{
+	// A PoolNodePtr can only point into the pool, so there is nowhere to fall back to
+	if (n != 1) { throw std::bad_alloc(); }
+	const FourBytePtr ptr(NodePool::Allocate());
+	if (ptr == NodePool::Pool::PtrType::NULL_PTR) { throw std::bad_alloc(); }
+	return pointer{ptr};
+}
+
+template<typename T, std::size_t maxElements, std::size_t bs, typename... Os>
+auto CompactPoolStlAllocator<T, maxElements, bs, Os...>::deallocate(pointer ptr, std::size_t)
+		-> void
+{
+	NodePool::Free(ptr.Index());
+}
+
+}// namespace hgalloc
@@ -0,0 +1,304 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * SizeClassAllocator.h
+ *		Variable sized allocations (strings, small vectors, messages) from a set of pools, one per
+ *		power of 2 size class from 16 to 4096 bytes. e.g.
+ *
+ *			SizeClassAllocator<1 << 20> allocator{64 << 20};
+ *			auto message(allocator.Allocate(length));
+ *			std::memcpy(message.get(), data, length);
+ *
+ *		The handle is still 4 bytes, the top CLASS_BITS bits are the size class and the rest the
+ *		index into that class's pool, and frees itself when it goes out of scope like
+ *		FourByteScopedPtr. Each class's buckets are bucketBytes long, so every class grows and
+ *		shrinks in the same sized steps.
+ *
+ *		Allocations bigger than MAX_CLASS_SIZE, or of a class whose pool is full, return a null
+ *		handle. The memory is uninitialised and 16 byte aligned. Like the pools, only one
+ *		allocator of each type can exist at a time.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace hgalloc {
+
+template<typename Allocator>
+class SizeClassPtr {
+public:
+	explicit SizeClassPtr(FourBytePtr);
+	static auto CreateNullPtr() -> SizeClassPtr;
+	~SizeClassPtr();
+
+	auto reset() -> void;
+	// Gives up ownership without freeing
+	auto release() -> FourBytePtr;
+	auto get() -> void *;
+	[[nodiscard]] auto get() const -> const void *;
+	// How many bytes get() points to, which is the whole size class rather than what was asked for
+	[[nodiscard]] auto Capacity() const -> std::size_t;
+
+	// moveable
+	SizeClassPtr(SizeClassPtr &&) noexcept;
+	SizeClassPtr &operator=(SizeClassPtr &&) noexcept;
+
+	// non-copyable
+	SizeClassPtr(const SizeClassPtr &) = delete;
+	SizeClassPtr &operator=(const SizeClassPtr &) = delete;
+
+	static constexpr FourBytePtr NULL_PTR{std::numeric_limits<FourBytePtr>::max()};
+
+	friend bool operator==(const std::nullptr_t &, const SizeClassPtr &rhs)
+	{
+		return NULL_PTR == rhs.ptr_;
+	}
+
+private:
+	FourBytePtr ptr_{NULL_PTR};
+};
+
+template<std::size_t bucketBytes, typename... Options>
+class SizeClassAllocator {
+public:
+	using PtrType = SizeClassPtr<SizeClassAllocator>;
+	friend PtrType;
+
+	static constexpr std::size_t MIN_CLASS_SIZE{16};
+	static constexpr std::size_t MAX_CLASS_SIZE{4'096};
+	static constexpr std::size_t NUM_OF_CLASSES{
+			std::bit_width(MAX_CLASS_SIZE) - std::bit_width(MIN_CLASS_SIZE) + 1};
+	static constexpr std::size_t CLASS_BITS{4};
+	static constexpr std::size_t INDEX_BITS{32 - CLASS_BITS};
+	static constexpr FourBytePtr INDEX_MASK{(FourBytePtr{1} << INDEX_BITS) - 1};
+	// The top index would be mistaken for NULL_PTR in the top class
+	static constexpr std::size_t MAX_ELEMENTS_PER_CLASS{INDEX_MASK};
+
+	static_assert(NUM_OF_CLASSES <= (std::size_t{1} << CLASS_BITS), "Not enough bits for classes");
+	static_assert(std::has_single_bit(bucketBytes) && bucketBytes >= MAX_CLASS_SIZE,
+				  "bucketBytes must be a power of 2 that holds at least one of the biggest class");
+
+	static constexpr auto ClassOf(std::size_t bytes) -> std::size_t;
+	static constexpr auto ClassSize(std::size_t sizeClass) -> std::size_t;
+
+	// The most memory each class can use, so the most elements of class c is
+	// maxBytesPerClass / ClassSize(c) (up to MAX_ELEMENTS_PER_CLASS)
+	explicit SizeClassAllocator(std::size_t maxBytesPerClass);
+
+	SizeClassAllocator(SizeClassAllocator &&) = delete;
+	SizeClassAllocator &operator=(SizeClassAllocator &&) = delete;
+	SizeClassAllocator(const SizeClassAllocator &) = delete;
+	SizeClassAllocator &operator=(const SizeClassAllocator &) = delete;
+
+	auto Allocate(std::size_t bytes) -> PtrType;
+
+	// Bytes handed out, counted as whole size classes
+	[[nodiscard]] auto BytesInUse() const -> std::size_t;
+	[[nodiscard]] auto Size(std::size_t sizeClass) const -> std::size_t;
+
+	static auto AddressOf(FourBytePtr) -> void *;
+
+private:
+	template<std::size_t sizeClass>
+	using ClassPool =
+			GrowingGlobalPoolAllocator<detail::RawNode<ClassSize(sizeClass), 16, SizeClassAllocator>,
+									   bucketBytes / ClassSize(sizeClass), Options...>;
+
+	template<typename ClassSequence>
+	struct PoolsFor;
+	template<std::size_t... sizeClasses>
+	struct PoolsFor<std::index_sequence<sizeClasses...>> {
+		using Type = std::tuple<ClassPool<sizeClasses>...>;
+	};
+	using Pools = typename PoolsFor<std::make_index_sequence<NUM_OF_CLASSES>>::Type;
+
+	// The pools can't be moved, so they are constructed in place from here
+	template<std::size_t... sizeClasses>
+	SizeClassAllocator(std::size_t maxBytesPerClass, std::index_sequence<sizeClasses...>);
+
+	// Calls f(std::integral_constant<std::size_t, sizeClass>) with the runtime sizeClass
+	template<typename F>
+	static auto Dispatch(std::size_t sizeClass, F &&f) -> decltype(auto);
+
+	static auto Free(FourBytePtr) -> void;
+
+	Pools pools_;
+};
+
+/*
+ * SizeClassPtr
+ */
+template<typename Allocator>
+SizeClassPtr<Allocator>::SizeClassPtr(FourBytePtr ptr) : ptr_(ptr)
+{
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::CreateNullPtr() -> SizeClassPtr
+{
+	return SizeClassPtr{NULL_PTR};
+}
+
+template<typename Allocator>
+SizeClassPtr<Allocator>::~SizeClassPtr()
+{
+	reset();
+}
+
+template<typename Allocator>
+SizeClassPtr<Allocator>::SizeClassPtr(SizeClassPtr &&rhs) noexcept
+	: ptr_(std::exchange(rhs.ptr_, NULL_PTR))
+{
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::operator=(SizeClassPtr &&rhs) noexcept -> SizeClassPtr &
+{
+	if (this != &rhs) {
+		reset();
+		ptr_ = std::exchange(rhs.ptr_, NULL_PTR);
+	}
+	return *this;
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::reset() -> void
+{
+	if (NULL_PTR != ptr_) {
+		Allocator::Free(ptr_);
+		ptr_ = NULL_PTR;
+	}
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::release() -> FourBytePtr
+{
+	return std::exchange(ptr_, NULL_PTR);
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::get() -> void *
+{
+	if (NULL_PTR == ptr_) { return nullptr; }
+	return Allocator::AddressOf(ptr_);
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::get() const -> const void *
+{
+	if (NULL_PTR == ptr_) { return nullptr; }
+	return Allocator::AddressOf(ptr_);
+}
+
+template<typename Allocator>
+auto SizeClassPtr<Allocator>::Capacity() const -> std::size_t
+{
+	if (NULL_PTR == ptr_) { return 0; }
+	return Allocator::ClassSize(ptr_ >> Allocator::INDEX_BITS);
+}
+
+/*
+ * SizeClassAllocator
+ */
+template<std::size_t bb, typename... Os>
+constexpr auto SizeClassAllocator<bb, Os...>::ClassOf(std::size_t bytes) -> std::size_t
+{
+	// The smallest power of 2 at least bytes
+	const std::size_t width(std::bit_width(std::max(bytes, MIN_CLASS_SIZE) - 1));
+	return width - (std::bit_width(MIN_CLASS_SIZE) - 1);
+}
+
+template<std::size_t bb, typename... Os>
+constexpr auto SizeClassAllocator<bb, Os...>::ClassSize(std::size_t sizeClass) -> std::size_t
+{
+	return MIN_CLASS_SIZE << sizeClass;
+}
+
+template<std::size_t bb, typename... Os>
+SizeClassAllocator<bb, Os...>::SizeClassAllocator(std::size_t maxBytesPerClass)
+	: SizeClassAllocator(maxBytesPerClass, std::make_index_sequence<NUM_OF_CLASSES>())
+{
+}
+
+template<std::size_t bb, typename... Os>
+template<std::size_t... sizeClasses>
+SizeClassAllocator<bb, Os...>::SizeClassAllocator(std::size_t maxBytesPerClass,
+												  std::index_sequence<sizeClasses...>)
+	: pools_(std::min(maxBytesPerClass / ClassSize(sizeClasses), MAX_ELEMENTS_PER_CLASS)...)
+{
+}
+
+template<std::size_t bb, typename... Os>
+template<typename F>
+auto SizeClassAllocator<bb, Os...>::Dispatch(std::size_t sizeClass, F &&f) -> decltype(auto)
+{
+	// A switch the compiler can turn into a jump table
+	HGALLOC_ASSERT(sizeClass < NUM_OF_CLASSES);
+	static_assert(NUM_OF_CLASSES == 9, "Add or remove cases to match the classes");
+	switch (sizeClass) {
+		case 0: return f(std::integral_constant<std::size_t, 0>());
+		case 1: return f(std::integral_constant<std::size_t, 1>());
+		case 2: return f(std::integral_constant<std::size_t, 2>());
+		case 3: return f(std::integral_constant<std::size_t, 3>());
+		case 4: return f(std::integral_constant<std::size_t, 4>());
+		case 5: return f(std::integral_constant<std::size_t, 5>());
+		case 6: return f(std::integral_constant<std::size_t, 6>());
+		case 7: return f(std::integral_constant<std::size_t, 7>());
+		default: return f(std::integral_constant<std::size_t, 8>());
+	}
+}
+
+template<std::size_t bb, typename... Os>
+auto SizeClassAllocator<bb, Os...>::Allocate(std::size_t bytes) -> PtrType
+{
+	if (bytes > MAX_CLASS_SIZE) { return PtrType::CreateNullPtr(); }
+
+	const std::size_t sizeClass(ClassOf(bytes));
+	return Dispatch(sizeClass, [this, sizeClass](auto c) {
+		const FourBytePtr index(std::get<c()>(pools_).Allocate().release());
+		if (index == PtrType::NULL_PTR) { return PtrType::CreateNullPtr(); }
+		return PtrType{static_cast<FourBytePtr>(sizeClass << INDEX_BITS) | index};
+	});
+}
+
+template<std::size_t bb, typename... Os>
+auto SizeClassAllocator<bb, Os...>::AddressOf(FourBytePtr ptr) -> void *
+{
+	return Dispatch(ptr >> INDEX_BITS, [ptr](auto c) -> void * {
+		return ClassPool<c()>::AddressOf(ptr & INDEX_MASK);
+	});
+}
+
+template<std::size_t bb, typename... Os>
+auto SizeClassAllocator<bb, Os...>::Free(FourBytePtr ptr) -> void
+{
+	Dispatch(ptr >> INDEX_BITS, [ptr](auto c) { ClassPool<c()>::FreeIndex(ptr & INDEX_MASK); });
+}
+
+template<std::size_t bb, typename... Os>
+auto SizeClassAllocator<bb, Os...>::Size(std::size_t sizeClass) const -> std::size_t
+{
+	return Dispatch(sizeClass, [this](auto c) { return std::get<c()>(pools_).Size(); });
+}
+
+template<std::size_t bb, typename... Os>
+auto SizeClassAllocator<bb, Os...>::BytesInUse() const -> std::size_t
+{
+	std::size_t bytes(0);
+	for (std::size_t sizeClass(0); sizeClass < NUM_OF_CLASSES; ++sizeClass) {
+		bytes += Size(sizeClass) * ClassSize(sizeClass);
+	}
+	return bytes;
+}
+
+}// namespace hgalloc
@@ -0,0 +1,184 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * SoaPoolAllocator.h
+ *		A pool that stores each field of its elements in its own array (structure of arrays), for
+ *		records where hot loops scan one or two fields across everything that's live. e.g.
+ *
+ *			enum Field { PRICE, SIZE, VENUE };
+ *			using Quotes = SoaPoolAllocator<std::tuple<double, double, std::uint32_t>, 16'384>;
+ *			Quotes quotes{1'000'000};
+ *			auto quote(quotes.Allocate(101.5, 200.0, 7));
+ *			Quotes::Get<PRICE>(quote) = 101.25;
+ *
+ *			for (std::size_t bucketNum(0); bucketNum < Quotes::NumOfBuckets(); ++bucketNum) {
+ *				if (!Quotes::IsBucketCreated(bucketNum)) { continue; }
+ *				for (const double price : Quotes::Column<PRICE>(bucketNum)) { ... }
+ *			}
+ *
+ *		Underneath is a GrowingGlobalPoolAllocator of 4 byte slots, which hold the free list links,
+ *		whose buckets carry a column array per field. So it grows and shrinks a bucket at a time
+ *		just like the pool, with the same Options, and the handle is the pool's 4 byte handle,
+ *		which indexes every column. Dereferencing the handle itself gives the slot, not the row.
+ *
+ *		Columns are plain arrays a scan can vectorise over, so their types must be trivially
+ *		copyable. A bucket's columns are value initialised when it is created, and a free row
+ *		keeps the values it was last given.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include "GrowingGlobalPoolAllocator_impl.h"
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace hgalloc {
+
+namespace detail {
+
+// Keeps every column in the storage the user's options asked for, alongside the pool's slots
+template<typename Inner, typename... Columns>
+struct ColumnStorageOption : StorageOption {
+	template<typename MemBlock, std::size_t bucketSize>
+	using Storage =
+			ColumnStorage<bucketSize, ColumnInit::Value,
+						  typename Inner::template Storage<MemBlock, bucketSize>,
+						  typename Inner::template Storage<Columns, bucketSize>...>;
+};
+
+}// namespace detail
+
+template<typename Columns, std::size_t bucketSize, typename... Options>
+class SoaPoolAllocator;
+
+template<typename... Columns, std::size_t bucketSize, typename... Options>
+class SoaPoolAllocator<std::tuple<Columns...>, bucketSize, Options...> {
+public:
+	static_assert(sizeof...(Columns) > 0, "Needs at least one column");
+	static_assert((std::is_trivially_copyable_v<Columns> && ...),
+				  "Columns are scanned as plain arrays, so must be trivially copyable");
+
+	// What the pool hands out. It's only used for the free list link while the row is free
+	struct Slot {
+		FourBytePtr link_{0};
+	};
+
+	// Our storage option comes first so it wins, the user's storage is used for every column
+	using Pool = GrowingGlobalPoolAllocator<
+			Slot, bucketSize, NaturalLayout,
+			detail::ColumnStorageOption<SelectOption<StorageOption, HeapBuckets, Options...>,
+										Columns...>,
+			Options...>;
+	using PtrType = typename Pool::PtrType;
+
+	template<std::size_t column>
+	using ColumnType = std::tuple_element_t<column, std::tuple<Columns...>>;
+	static constexpr std::size_t NUM_OF_COLUMNS{sizeof...(Columns)};
+
+	explicit SoaPoolAllocator(std::size_t maxElements);
+
+	SoaPoolAllocator(SoaPoolAllocator &&) = delete;
+	SoaPoolAllocator &operator=(SoaPoolAllocator &&) = delete;
+	SoaPoolAllocator(const SoaPoolAllocator &) = delete;
+	SoaPoolAllocator &operator=(const SoaPoolAllocator &) = delete;
+
+	// Returns a null handle if the pool is full
+	auto Allocate(const Columns &...values) -> PtrType;
+
+	template<std::size_t column>
+	[[nodiscard]] static auto Get(const PtrType &ptr) -> ColumnType<column> &;
+	template<std::size_t column>
+	[[nodiscard]] static auto Get(FourBytePtr ptr) -> ColumnType<column> &;
+
+	// The whole of a column in one bucket, free rows included. Only valid while the bucket is
+	// created, and an element's row is its handle's index minus bucketNum * bucketSize.
+	template<std::size_t column>
+	[[nodiscard]] static auto Column(std::size_t bucketNum)
+			-> std::span<ColumnType<column>, bucketSize>;
+	// How many buckets the pool could grow to, not how many it has
+	[[nodiscard]] static auto NumOfBuckets() -> std::size_t;
+	[[nodiscard]] static auto IsBucketCreated(std::size_t bucketNum) -> bool;
+
+	[[nodiscard]] auto Size() const -> std::size_t;
+	[[nodiscard]] auto Capacity() const -> std::size_t;
+
+private:
+	Pool pool_;
+};
+
+template<typename... Cs, std::size_t bs, typename... Os>
+SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::SoaPoolAllocator(std::size_t maxElements)
+	: pool_(maxElements)
+{
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Allocate(const Cs &...values) -> PtrType
+{
+	auto ptr(pool_.Allocate());
+	if (nullptr == ptr) { return ptr; }
+
+	const auto &buckets(Pool::Buckets());
+	[&]<std::size_t... columns>(std::index_sequence<columns...>) {
+		((buckets.template Column<columns>().Get(ptr.Index()) = values), ...);
+	}(std::index_sequence_for<Cs...>{});
+	return ptr;
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+template<std::size_t column>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Get(const PtrType &ptr)
+		-> ColumnType<column> &
+{
+	return Get<column>(ptr.Index());
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+template<std::size_t column>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Get(FourBytePtr ptr) -> ColumnType<column> &
+{
+	HGALLOC_ASSERT(ptr != PtrType::NULL_PTR);
+	return Pool::Buckets().template Column<column>().Get(ptr);
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+template<std::size_t column>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Column(std::size_t bucketNum)
+		-> std::span<ColumnType<column>, bs>
+{
+	HGALLOC_ASSERT(IsBucketCreated(bucketNum));
+	const auto first(static_cast<FourBytePtr>(bucketNum * bs));
+	return std::span<ColumnType<column>, bs>{&Get<column>(first), bs};
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::NumOfBuckets() -> std::size_t
+{
+	return Pool::Buckets().NumOfBuckets();
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::IsBucketCreated(std::size_t bucketNum)
+		-> bool
+{
+	return Pool::Buckets().IsCreated(bucketNum);
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Size() const -> std::size_t
+{
+	return pool_.Size();
+}
+
+template<typename... Cs, std::size_t bs, typename... Os>
+auto SoaPoolAllocator<std::tuple<Cs...>, bs, Os...>::Capacity() const -> std::size_t
+{
+	return pool_.Capacity();
+}
+
+}// namespace hgalloc
@@ -0,0 +1,174 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * test/LatencyHistogram.h
+ *		What the tail latency benchmarks use to time and record every single Allocate and Free.
+ *
+ *		LatencyClock reads the TSC where we have one, as steady_clock::now() costs several times
+ *		more than the calls we are timing, and converts ticks to nanoseconds with a ratio measured
+ *		against steady_clock the first time it is used.
+ *
+ *		LatencyHistogram is HDR style. Values below 2^SUB_BUCKET_BITS get a counter each, above
+ *		that each power of two is split into 2^(SUB_BUCKET_BITS - 1) counters. So any value is
+ *		recorded to within 1/64th of itself with a few thousand counters, and recording is a
+ *		count leading zeros and an increment.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HGALLOC_HAVE_RDTSC 1
+#endif
+
+namespace hgalloc {
+
+class LatencyClock {
+public:
+	using Ticks = std::uint64_t;
+
+	static auto Now() -> Ticks;
+	static auto ToNanoseconds(Ticks) -> double;
+
+private:
+	static auto MeasureNanosecondsPerTick() -> double;
+};
+
+class LatencyHistogram {
+public:
+	constexpr static std::size_t SUB_BUCKET_BITS{7};
+
+	auto Record(std::uint64_t value) -> void;
+	auto Merge(const LatencyHistogram &) -> void;
+	auto Reset() -> void;
+
+	[[nodiscard]] auto Count() const -> std::uint64_t;
+	[[nodiscard]] auto Max() const -> std::uint64_t;
+	// The smallest recorded value that percentile% of the values are less than or equal to,
+	// rounded up to the top of its counter's range. 0 if nothing has been recorded
+	[[nodiscard]] auto Percentile(double percentile) const -> std::uint64_t;
+
+	// Exposed for the tests
+	static auto IndexOf(std::uint64_t value) -> std::size_t;
+	static auto HighestValueAt(std::size_t index) -> std::uint64_t;
+
+private:
+	constexpr static std::uint64_t LINEAR_COUNTERS{std::uint64_t{1} << SUB_BUCKET_BITS};
+	constexpr static std::uint64_t HALF_LINEAR_COUNTERS{LINEAR_COUNTERS / 2};
+	constexpr static std::size_t NUM_OF_COUNTERS{
+			LINEAR_COUNTERS + (64 - SUB_BUCKET_BITS) * HALF_LINEAR_COUNTERS};
+
+	std::array<std::uint64_t, NUM_OF_COUNTERS> counters_{};
+	std::uint64_t count_{0};
+	std::uint64_t max_{0};
+};
+
+inline auto LatencyClock::Now() -> Ticks
+{
+#ifdef HGALLOC_HAVE_RDTSC
+	// The fences stop the read being reordered with the call we are timing
+	_mm_lfence();
+	const Ticks ticks(__rdtsc());
+	_mm_lfence();
+	return ticks;
+#else
+	return static_cast<Ticks>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline auto LatencyClock::ToNanoseconds(Ticks ticks) -> double
+{
+	static const double nanosecondsPerTick(MeasureNanosecondsPerTick());
+	return static_cast<double>(ticks) * nanosecondsPerTick;
+}
+
+inline auto LatencyClock::MeasureNanosecondsPerTick() -> double
+{
+#ifdef HGALLOC_HAVE_RDTSC
+	const auto start(std::chrono::steady_clock::now());
+	const Ticks startTicks(Now());
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	const Ticks endTicks(Now());
+	const std::chrono::duration<double, std::nano> elapsed(std::chrono::steady_clock::now() -
+														   start);
+	return elapsed.count() / static_cast<double>(endTicks - startTicks);
+#else
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1))
+			.count();
+#endif
+}
+
+inline auto LatencyHistogram::IndexOf(std::uint64_t value) -> std::size_t
+{
+	if (value < LINEAR_COUNTERS) { return value; }
+
+	// Keep the top SUB_BUCKET_BITS bits, whose leading one is always set
+	const auto shift(static_cast<std::size_t>(std::bit_width(value)) - SUB_BUCKET_BITS);
+	const std::uint64_t topBits(value >> shift);
+	return LINEAR_COUNTERS + (shift - 1) * HALF_LINEAR_COUNTERS + (topBits - HALF_LINEAR_COUNTERS);
+}
+
+inline auto LatencyHistogram::HighestValueAt(std::size_t index) -> std::uint64_t
+{
+	if (index < LINEAR_COUNTERS) { return index; }
+
+	const std::size_t shift((index - LINEAR_COUNTERS) / HALF_LINEAR_COUNTERS + 1);
+	const std::uint64_t topBits((index - LINEAR_COUNTERS) % HALF_LINEAR_COUNTERS +
+								HALF_LINEAR_COUNTERS);
+	return (topBits << shift) + ((std::uint64_t{1} << shift) - 1);
+}
+
+inline auto LatencyHistogram::Record(std::uint64_t value) -> void
+{
+	++counters_[IndexOf(value)];
+	++count_;
+	max_ = std::max(max_, value);
+}
+
+inline auto LatencyHistogram::Merge(const LatencyHistogram &rhs) -> void
+{
+	for (std::size_t i(0); i < NUM_OF_COUNTERS; ++i) { counters_[i] += rhs.counters_[i]; }
+	count_ += rhs.count_;
+	max_ = std::max(max_, rhs.max_);
+}
+
+inline auto LatencyHistogram::Reset() -> void
+{
+	*this = LatencyHistogram{};
+}
+
+inline auto LatencyHistogram::Count() const -> std::uint64_t
+{
+	return count_;
+}
+
+inline auto LatencyHistogram::Max() const -> std::uint64_t
+{
+	return max_;
+}
+
+inline auto LatencyHistogram::Percentile(double percentile) const -> std::uint64_t
+{
+	if (count_ == 0) { return 0; }
+
+	const double rank(std::ceil(percentile / 100.0 * static_cast<double>(count_)));
+	const auto wanted(std::max(std::uint64_t{1}, static_cast<std::uint64_t>(rank)));
+	std::uint64_t seen(0);
+	for (std::size_t i(0); i < NUM_OF_COUNTERS; ++i) {
+		seen += counters_[i];
+		// The top counter's range can go past the biggest value we actually saw
+		if (seen >= wanted) { return std::min(HighestValueAt(i), max_); }
+	}
+	return max_;
+}
+
+}// namespace hgalloc
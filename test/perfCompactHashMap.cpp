@@ -0,0 +1,143 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * test/perfCompactHashMap.cpp
+ *		CompactHashMap against std::unordered_map for a map of small records: building it, random
+ *		lookups and random replaces. Each benchmark reports the bytes per element the map used,
+ *		read from the pool or from a counting allocator.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../CompactHashMap.h"
+
+#include <array>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace hgalloc {
+
+struct Record {
+	std::array<std::uint32_t, 4> fields_;
+};
+
+constexpr std::size_t numElements{1'000'000};
+constexpr std::size_t numOperations{100'000};
+
+// Adds up what the unordered_map asks for, so it can be compared with the pool's size
+std::size_t allocatedBytes{0};
+
+template<typename T>
+struct CountingAllocator {
+	using value_type = T;
+
+	CountingAllocator() = default;
+	template<typename U>
+	// NOLINTNEXTLINE(google-explicit-constructor)
+	CountingAllocator(const CountingAllocator<U> &)
+	{
+	}
+
+	auto allocate(std::size_t n) -> T *
+	{
+		allocatedBytes += n * sizeof(T);
+		return std::allocator<T>{}.allocate(n);
+	}
+	auto deallocate(T *ptr, std::size_t n) -> void
+	{
+		allocatedBytes -= n * sizeof(T);
+		std::allocator<T>{}.deallocate(ptr, n);
+	}
+
+	friend auto operator==(const CountingAllocator &, const CountingAllocator &) -> bool
+	{
+		return true;
+	}
+};
+
+struct StdMap {
+	using Map = std::unordered_map<std::uint64_t, Record, std::hash<std::uint64_t>,
+								   std::equal_to<>,
+								   CountingAllocator<std::pair<const std::uint64_t, Record>>>;
+
+	Map map_;
+
+	auto BytesUsed() const -> std::size_t { return allocatedBytes; }
+};
+
+struct CompactMap {
+	using Map = CompactHashMap<std::uint64_t, Record, 16'384>;
+
+	Map::Pool pool_{numElements};
+	Map map_{pool_};
+
+	auto BytesUsed() const -> std::size_t
+	{
+		return pool_.Size() * sizeof(Map::Node) + map_.bucket_count() * sizeof(FourBytePtr);
+	}
+};
+
+auto RandomKeys(std::size_t count, std::uint32_t seed) -> std::vector<std::uint64_t>
+{
+	std::mt19937_64 gen(seed);
+	std::uniform_int_distribution<std::uint64_t> dis(0, numElements - 1);
+	std::vector<std::uint64_t> keys(count);
+	for (auto &key : keys) { key = dis(gen); }
+	return keys;
+}
+
+template<typename Maker>
+void BuildBM(benchmark::State &state)
+{
+	for (auto _ : state) {
+		Maker maker;
+		for (std::uint64_t i(0); i < numElements; ++i) { maker.map_[i] = Record{}; }
+		state.counters["bytesPerElement"] =
+				static_cast<double>(maker.BytesUsed()) / static_cast<double>(numElements);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numElements));
+}
+BENCHMARK_TEMPLATE(BuildBM, StdMap)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BuildBM, CompactMap)->Unit(benchmark::kMillisecond);
+
+template<typename Maker>
+void RandomLookupBM(benchmark::State &state)
+{
+	Maker maker;
+	for (std::uint64_t i(0); i < numElements; ++i) { maker.map_[i] = Record{}; }
+	const auto keys(RandomKeys(numOperations, 3));
+
+	for (auto _ : state) {
+		std::uint32_t sum(0);
+		for (const auto key : keys) { sum += maker.map_.find(key)->second.fields_[0]; }
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numOperations));
+}
+BENCHMARK_TEMPLATE(RandomLookupBM, StdMap);
+BENCHMARK_TEMPLATE(RandomLookupBM, CompactMap);
+
+template<typename Maker>
+void RandomReplaceBM(benchmark::State &state)
+{
+	Maker maker;
+	for (std::uint64_t i(0); i < numElements; ++i) { maker.map_[i] = Record{}; }
+	const auto keys(RandomKeys(numOperations, 5));
+
+	for (auto _ : state) {
+		for (const auto key : keys) {
+			maker.map_.erase(key);
+			maker.map_[key] = Record{};
+		}
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numOperations));
+}
+BENCHMARK_TEMPLATE(RandomReplaceBM, StdMap);
+BENCHMARK_TEMPLATE(RandomReplaceBM, CompactMap);
+
+}// namespace hgalloc
+
+BENCHMARK_MAIN();
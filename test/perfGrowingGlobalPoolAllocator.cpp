@@ -10,7 +10,13 @@
 #include <memory>
 
 #include "../GrowingGlobalPoolAllocator_impl.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
 #include <random>
+#include <span>
+#include <thread>
 #include <valgrind/callgrind.h>
 #include <vector>
 
@@ -48,6 +54,126 @@ void GrowingGlobalPoolAllocatorBM(benchmark::State &state)
 }
 BENCHMARK(GrowingGlobalPoolAllocatorBM);
 
+void UniquePtrMultiThreadedBM(benchmark::State &state)
+{
+	const auto perThread(runSize / state.threads());
+	std::vector<std::unique_ptr<BigType>> ret;
+	ret.reserve(perThread);
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < perThread; ++i) { ret.push_back(std::make_unique<BigType>()); }
+		ret.clear();
+	}
+	state.SetItemsProcessed(state.iterations() * perThread);
+}
+BENCHMARK(UniquePtrMultiThreadedBM)->ThreadRange(1, std::thread::hardware_concurrency());
+
+void GrowingGlobalPoolAllocatorThreadCachedBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 16'384, ThreadCached<64>>;
+	// Shared by every thread of every run, lives until the end of the program
+	static Allocator allocator{100'000};
+
+	const auto perThread(runSize / state.threads());
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(perThread);
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < perThread; ++i) { ret.push_back(allocator.Allocate()); }
+		ret.clear();
+	}
+	state.SetItemsProcessed(state.iterations() * perThread);
+}
+BENCHMARK(GrowingGlobalPoolAllocatorThreadCachedBM)
+		->ThreadRange(1, std::thread::hardware_concurrency());
+
+// Just enough of a single producer single consumer queue to hand objects to another thread
+// without the queue dominating the benchmark
+template<typename Value, std::size_t capacity>
+class SpscRing {
+public:
+	auto TryPush(Value &value) -> bool
+	{
+		const auto tail(tail_.load(std::memory_order_relaxed));
+		if (tail - head_.load(std::memory_order_acquire) == capacity) { return false; }
+		slots_[tail % capacity] = std::move(value);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	auto TryPop() -> std::optional<Value>
+	{
+		const auto head(head_.load(std::memory_order_relaxed));
+		if (head == tail_.load(std::memory_order_acquire)) { return std::nullopt; }
+		std::optional<Value> ret(std::move(slots_[head % capacity]));
+		slots_[head % capacity].reset();
+		head_.store(head + 1, std::memory_order_release);
+		return ret;
+	}
+
+private:
+	std::array<std::optional<Value>, capacity> slots_;
+	alignas(64) std::atomic<std::size_t> head_{0};
+	alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+// Allocates on this thread and frees everything on another
+template<typename Make>
+void ProducerConsumer(benchmark::State &state, Make make)
+{
+	using Value = decltype(make());
+
+	for (auto _ : state) {
+		auto ring(std::make_unique<SpscRing<Value, 1'024>>());
+
+		std::thread consumer([&]() {
+			for (std::size_t i(0); i < runSize; ++i) {
+				while (!ring->TryPop()) { std::this_thread::yield(); }
+			}
+		});
+
+		for (std::size_t i(0); i < runSize; ++i) {
+			auto value(make());
+			while (!ring->TryPush(value)) { std::this_thread::yield(); }
+		}
+		consumer.join();
+	}
+	state.SetItemsProcessed(state.iterations() * runSize);
+}
+
+void UniquePtrProducerConsumerBM(benchmark::State &state)
+{
+	ProducerConsumer(state, []() { return std::make_unique<BigType>(); });
+}
+BENCHMARK(UniquePtrProducerConsumerBM);
+
+void GrowingGlobalPoolAllocatorLockFreeProducerConsumerBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 16'384, LockFree>;
+	Allocator allocator{100'000};
+	ProducerConsumer(state, [&]() { return allocator.Allocate(); });
+}
+BENCHMARK(GrowingGlobalPoolAllocatorLockFreeProducerConsumerBM);
+
+void GrowingGlobalPoolAllocatorLockFreeBM(benchmark::State &state)
+{
+	// Different bucket size to the producer consumer benchmark so this gets its own pool, which is
+	// shared by every thread of every run and lives until the end of the program
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 8'192, LockFree>;
+	static Allocator allocator{100'000};
+
+	const auto perThread(runSize / state.threads());
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(perThread);
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < perThread; ++i) { ret.push_back(allocator.Allocate()); }
+		ret.clear();
+	}
+	state.SetItemsProcessed(state.iterations() * perThread);
+}
+BENCHMARK(GrowingGlobalPoolAllocatorLockFreeBM)->ThreadRange(1, std::thread::hardware_concurrency());
+
 void UniquePtrRoundRobinBM(benchmark::State &state)
 {
 	std::vector<std::unique_ptr<BigType>> ret;
@@ -85,6 +211,32 @@ void GrowingGlobalPoolAllocatorRoundRobinBM(benchmark::State &state)
 
 BENCHMARK(GrowingGlobalPoolAllocatorRoundRobinBM);
 
+// Same as above but freeing and allocating in batches, like our ingest path
+std::size_t batchSize{256};
+
+void GrowingGlobalPoolAllocatorBatchRoundRobinBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 16'384>;
+	Allocator allocator{100'000};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(runSize);
+	auto perRun(runSize / 10);
+
+	// Fill Vector
+	allocator.AllocateN(runSize, std::back_inserter(ret));
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < perRun; i += batchSize) {
+			allocator.FreeN(std::span(ret).subspan(i, std::min(batchSize, perRun - i)));
+		}
+		ret.erase(ret.begin(), ret.begin() + perRun);
+		for (std::size_t i(0); i < perRun; i += batchSize) {
+			allocator.AllocateN(std::min(batchSize, perRun - i), std::back_inserter(ret));
+		}
+	}
+}
+BENCHMARK(GrowingGlobalPoolAllocatorBatchRoundRobinBM);
+
 void UniquePtrLastRecordBM(benchmark::State &state)
 {
 	std::vector<std::unique_ptr<BigType>> ret;
@@ -119,6 +271,29 @@ void GrowingGlobalPoolAllocatorLastRecordBM(benchmark::State &state)
 }
 BENCHMARK(GrowingGlobalPoolAllocatorLastRecordBM);
 
+void GrowingGlobalPoolAllocatorBatchLastRecordBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 16'384>;
+	Allocator allocator{100'000};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(runSize);
+	auto perRun(runSize / 10);
+
+	// Fill Vector
+	allocator.AllocateN(runSize, std::back_inserter(ret));
+
+	for (auto _ : state) {
+		for (std::size_t i(runSize - perRun); i < runSize; i += batchSize) {
+			allocator.FreeN(std::span(ret).subspan(i, std::min(batchSize, runSize - i)));
+		}
+		ret.erase(ret.end() - perRun, ret.end());
+		for (std::size_t i(0); i < perRun; i += batchSize) {
+			allocator.AllocateN(std::min(batchSize, perRun - i), std::back_inserter(ret));
+		}
+	}
+}
+BENCHMARK(GrowingGlobalPoolAllocatorBatchLastRecordBM);
+
 std::size_t numRandomDeletes(1'000);
 
 void UniquePtrRandomReplaceBM(benchmark::State &state)
@@ -175,6 +350,67 @@ void GrowingGlobalPoolAllocatorRandomReplaceBM(benchmark::State &state)
 }
 BENCHMARK(GrowingGlobalPoolAllocatorRandomReplaceBM);
 
+// Lots of small buckets with holes at both ends, so every other allocation has to find a free
+// list a long way above the last one it used
+void GrowingGlobalPoolAllocatorManyBucketsLowAndHighReplaceBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<BigType, 64>;
+	Allocator allocator{100'000};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(runSize);
+
+	// Fill Vector
+	for (std::size_t i(0); i < runSize; ++i) { ret.push_back(allocator.Allocate()); }
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < numRandomDeletes; ++i) {
+			ret[i].reset();
+			ret[runSize - 1 - i].reset();
+			ret[i] = allocator.Allocate();
+			ret[runSize - 1 - i] = allocator.Allocate();
+		}
+	}
+}
+BENCHMARK(GrowingGlobalPoolAllocatorManyBucketsLowAndHighReplaceBM);
+
+// The worst single Allocate and Free, which is where creating and freeing buckets shows up. Both
+// variants call Maintain() every so often, it only does anything with DeferredMaintenance.
+template<typename Allocator>
+void GrowingGlobalPoolAllocatorWorstCaseBM(benchmark::State &state)
+{
+	Allocator allocator{runSize};
+	std::vector<typename Allocator::PtrType> ret;
+	ret.reserve(runSize);
+
+	std::chrono::steady_clock::duration worstAllocate{};
+	std::chrono::steady_clock::duration worstFree{};
+	for (auto _ : state) {
+		for (std::size_t i(0); i < runSize; ++i) {
+			if (i % 1'024 == 0) { allocator.Maintain(); }
+
+			const auto start(std::chrono::steady_clock::now());
+			ret.push_back(allocator.Allocate());
+			worstAllocate = std::max(worstAllocate, std::chrono::steady_clock::now() - start);
+		}
+		for (std::size_t i(0); i < runSize; ++i) {
+			if (i % 1'024 == 0) { allocator.Maintain(); }
+
+			const auto start(std::chrono::steady_clock::now());
+			ret.pop_back();
+			worstFree = std::max(worstFree, std::chrono::steady_clock::now() - start);
+		}
+	}
+
+	state.counters["worstAllocateNs"] = static_cast<double>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(worstAllocate).count());
+	state.counters["worstFreeNs"] = static_cast<double>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(worstFree).count());
+}
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorWorstCaseBM,
+				   GrowingGlobalPoolAllocator<BigType, 16'384, InlineMaintenance>);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorWorstCaseBM,
+				   GrowingGlobalPoolAllocator<BigType, 16'384, DeferredMaintenance>);
+
 void UniquePtrSequentialAccessBM(benchmark::State &state)
 {
 	std::vector<std::unique_ptr<int>> ret;
@@ -242,6 +478,193 @@ void GrowingGlobalPoolAllocatorRandomAccessBM(benchmark::State &state)
 }
 BENCHMARK(GrowingGlobalPoolAllocatorRandomAccessBM);
 
+void GrowingGlobalPoolAllocatorReservedRandomAccessBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<int, 16'384, ReservedAddressSpace>;
+	Allocator allocator{100'000};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(runSize);
+
+	for (std::size_t i(0); i < runSize; ++i) { ret.push_back(allocator.Allocate(i)); }
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<> dis(0, ret.size() - 1);
+
+	std::vector<std::size_t> randomLocations;
+	randomLocations.resize(numRandomDeletes);
+	for (std::size_t i(0); i < runSize; ++i) { randomLocations.push_back(dis(gen)); }
+
+	for (auto _ : state) {
+		for (const auto &var : randomLocations) { benchmark::DoNotOptimize(*ret[var]); }
+	}
+}
+BENCHMARK(GrowingGlobalPoolAllocatorReservedRandomAccessBM);
+
+// Pools big enough that access is dominated by dTLB misses, to compare normal and huge pages. The
+// buckets are 16'384 * 128 = 2MB so huge page buckets have no padding.
+std::size_t largePoolSize{2'000'000};
+
+struct MediumType {
+	char var_[128];
+};
+
+template<typename Storage>
+void GrowingGlobalPoolAllocatorLargeSequentialAccessBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<MediumType, 16'384, Storage>;
+	Allocator allocator{largePoolSize};
+	std::vector<typename Allocator::PtrType> ret;
+	ret.reserve(largePoolSize);
+
+	for (std::size_t i(0); i < largePoolSize; ++i) { ret.push_back(allocator.Allocate()); }
+	for (auto _ : state) {
+		for (const auto &var : ret) { benchmark::DoNotOptimize(var->var_[0]); }
+	}
+}
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeSequentialAccessBM, HeapBuckets);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeSequentialAccessBM, ReservedAddressSpace);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeSequentialAccessBM, TransparentHugePages);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeSequentialAccessBM, ExplicitHugePages);
+
+template<typename Storage>
+void GrowingGlobalPoolAllocatorLargeRandomAccessBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<MediumType, 16'384, Storage>;
+	Allocator allocator{largePoolSize};
+	std::vector<typename Allocator::PtrType> ret;
+	ret.reserve(largePoolSize);
+
+	for (std::size_t i(0); i < largePoolSize; ++i) { ret.push_back(allocator.Allocate()); }
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<std::size_t> dis(0, ret.size() - 1);
+
+	std::vector<std::size_t> randomLocations;
+	for (std::size_t i(0); i < runSize; ++i) { randomLocations.push_back(dis(gen)); }
+
+	for (auto _ : state) {
+		for (const auto &var : randomLocations) {
+			benchmark::DoNotOptimize(ret[var]->var_[0]);
+		}
+	}
+}
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeRandomAccessBM, HeapBuckets);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeRandomAccessBM, ReservedAddressSpace);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeRandomAccessBM, TransparentHugePages);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorLargeRandomAccessBM, ExplicitHugePages);
+
+// A session with a timeout, the sort of thing a sweep goes looking for
+struct Session {
+	std::uint64_t id_;
+	std::int64_t deadline_;
+};
+
+// Sweeping every live element of a large pool with a quarter of its elements freed at random.
+// Owners usually keep their handles in something like a hash map, so the handles are shuffled.
+template<bool forEachLive>
+void GrowingGlobalPoolAllocatorSweepBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<Session, 16'384, TrackLiveObjects>;
+	Allocator allocator{largePoolSize};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(largePoolSize);
+
+	for (std::size_t i(0); i < largePoolSize; ++i) {
+		ret.push_back(allocator.Allocate(Session{i, static_cast<std::int64_t>(i)}));
+	}
+	std::mt19937 gen(100);
+	std::shuffle(ret.begin(), ret.end(), gen);
+	ret.erase(ret.begin() + static_cast<std::ptrdiff_t>(largePoolSize / 4 * 3), ret.end());
+
+	for (auto _ : state) {
+		// Counted so every element really is read
+		std::size_t expired(0);
+		if constexpr (forEachLive) {
+			Allocator::ForEachLive([&expired](const Session &session) {
+				expired += session.deadline_ < 1'000 ? 1 : 0;
+			});
+		} else {
+			for (const auto &session : ret) { expired += session->deadline_ < 1'000 ? 1 : 0; }
+		}
+		benchmark::DoNotOptimize(expired);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ret.size()));
+}
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorSweepBM, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorSweepBM, true)->Unit(benchmark::kMillisecond);
+
+// The same sweep split across 1 to N threads by ForEachLiveParallel
+void GrowingGlobalPoolAllocatorParallelSweepBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<Session, 16'384, TrackLiveObjects>;
+	Allocator allocator{largePoolSize};
+	std::vector<Allocator::PtrType> ret;
+	ret.reserve(largePoolSize);
+
+	for (std::size_t i(0); i < largePoolSize; ++i) {
+		ret.push_back(allocator.Allocate(Session{i, static_cast<std::int64_t>(i)}));
+	}
+	std::mt19937 gen(100);
+	std::shuffle(ret.begin(), ret.end(), gen);
+	ret.erase(ret.begin() + static_cast<std::ptrdiff_t>(largePoolSize / 4 * 3), ret.end());
+
+	const auto numThreads(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state) {
+		std::atomic<std::size_t> expired(0);
+		Allocator::ForEachLiveParallel(numThreads, [&expired](const Session &session) {
+			if (session.deadline_ < 1'000) { expired.fetch_add(1, std::memory_order_relaxed); }
+		});
+		benchmark::DoNotOptimize(expired.load());
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ret.size()));
+}
+BENCHMARK(GrowingGlobalPoolAllocatorParallelSweepBM)
+		->RangeMultiplier(2)
+		->Range(1, 16)
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+
+// Taking and dropping a second reference to every element of a shuffled set of shared elements.
+// The shared_ptrs are 16 bytes and each count is in its own control block, ours are 4 bytes and
+// the counts are packed beside their buckets.
+void SharedPtrCopyBM(benchmark::State &state)
+{
+	std::vector<std::shared_ptr<std::uint64_t>> ret;
+	for (std::uint64_t i(0); i < largePoolSize; ++i) {
+		ret.push_back(std::make_shared<std::uint64_t>(i));
+	}
+	std::mt19937 gen(100);
+	std::shuffle(ret.begin(), ret.end(), gen);
+
+	for (auto _ : state) {
+		std::vector<std::shared_ptr<std::uint64_t>> copies(ret.begin(), ret.end());
+		benchmark::DoNotOptimize(copies.data());
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ret.size()));
+}
+BENCHMARK(SharedPtrCopyBM)->Unit(benchmark::kMillisecond);
+
+template<typename RefCounts>
+void GrowingGlobalPoolAllocatorSharedCopyBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 16'384, RefCounts>;
+	Allocator allocator{largePoolSize};
+	std::vector<typename Allocator::SharedPtrType> ret;
+	for (std::uint64_t i(0); i < largePoolSize; ++i) {
+		ret.push_back(allocator.AllocateShared(i));
+	}
+	std::mt19937 gen(100);
+	std::shuffle(ret.begin(), ret.end(), gen);
+
+	for (auto _ : state) {
+		std::vector<typename Allocator::SharedPtrType> copies(ret.begin(), ret.end());
+		benchmark::DoNotOptimize(copies.data());
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ret.size()));
+}
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorSharedCopyBM, RefCounted)
+		->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(GrowingGlobalPoolAllocatorSharedCopyBM, AtomicRefCounted)
+		->Unit(benchmark::kMillisecond);
+
 void UniquePtrFreeSequentialBM(benchmark::State &state)
 {
 	std::vector<std::unique_ptr<int>> ret;
@@ -0,0 +1,276 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * test/perfMultiThreaded.cpp
+ *		The pool against malloc and the std::pmr pool resources across 1 to <cores> threads, in the
+ *		three ways our worker threads use memory:
+ *
+ *			ThreadLocalChurn - each thread allocates a batch and frees it itself
+ *			CrossThreadFree - each thread allocates a batch and frees a batch allocated by another
+ *			SharedRandomReplace - threads replace random elements of one shared table
+ *
+ *		unsynchronized_pool_resource isn't thread safe, so it gets one resource per thread where
+ *		only that thread frees and one resource behind a mutex otherwise, which is how we would
+ *		have to use it.
+ *
+ *		Every backend lives until the end of the program and is shared by every thread of every
+ *		run, like it would be in a server.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../GrowingGlobalPoolAllocator_impl.h"
+
+#include <array>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace hgalloc {
+
+// A typical small record
+struct Record {
+	std::array<std::uint64_t, 8> fields_;
+};
+
+constexpr std::size_t batchSize{1'024};
+constexpr std::size_t sharedTableSize{100'000};
+constexpr std::size_t replacesPerIteration{1'024};
+constexpr std::size_t maxPoolElements{4'000'000};
+
+/*
+ * Backends. Each has a Handle that frees the record when it goes out of scope and a static
+ * Allocate()
+ */
+struct MallocBackend {
+	struct Deleter {
+		auto operator()(Record *record) const -> void
+		{
+			record->~Record();
+			std::free(record);
+		}
+	};
+	using Handle = std::unique_ptr<Record, Deleter>;
+
+	static auto Allocate() -> Handle
+	{
+		void *memory(std::malloc(sizeof(Record)));
+		if (memory == nullptr) { throw std::bad_alloc(); }
+		return Handle{new (memory) Record{}};
+	}
+};
+
+// Adds a mutex to an unsynchronized resource so any thread can use it
+class LockedPoolResource : public std::pmr::memory_resource {
+private:
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override
+	{
+		std::scoped_lock lock(mutex_);
+		return resource_.allocate(bytes, alignment);
+	}
+
+	auto do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) -> void override
+	{
+		std::scoped_lock lock(mutex_);
+		resource_.deallocate(ptr, bytes, alignment);
+	}
+
+	[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &rhs) const noexcept
+			-> bool override
+	{
+		return this == &rhs;
+	}
+
+	std::mutex mutex_;
+	std::pmr::unsynchronized_pool_resource resource_;
+};
+
+// GetResource returns the resource to use on the calling thread
+template<auto GetResource>
+struct PmrBackend {
+	struct Deleter {
+		auto operator()(Record *record) const -> void
+		{
+			record->~Record();
+			GetResource()->deallocate(record, sizeof(Record), alignof(Record));
+		}
+	};
+	using Handle = std::unique_ptr<Record, Deleter>;
+
+	static auto Allocate() -> Handle
+	{
+		return Handle{new (GetResource()->allocate(sizeof(Record), alignof(Record))) Record{}};
+	}
+};
+
+auto SynchronizedResource() -> std::pmr::memory_resource *
+{
+	static std::pmr::synchronized_pool_resource resource;
+	return &resource;
+}
+
+auto PerThreadUnsynchronizedResource() -> std::pmr::memory_resource *
+{
+	static thread_local std::pmr::unsynchronized_pool_resource resource;
+	return &resource;
+}
+
+auto LockedUnsynchronizedResource() -> std::pmr::memory_resource *
+{
+	static LockedPoolResource resource;
+	return &resource;
+}
+
+using PmrSynchronized = PmrBackend<SynchronizedResource>;
+using PmrUnsynchronizedPerThread = PmrBackend<PerThreadUnsynchronizedResource>;
+using PmrUnsynchronizedLocked = PmrBackend<LockedUnsynchronizedResource>;
+
+template<typename... Options>
+struct PoolBackend {
+	using Allocator = GrowingGlobalPoolAllocator<Record, 16'384, Options...>;
+	using Handle = typename Allocator::PtrType;
+
+	static auto Allocate() -> Handle
+	{
+		static Allocator allocator{maxPoolElements};
+		return allocator.Allocate();
+	}
+};
+
+using PoolThreadCached = PoolBackend<ThreadCached<64>>;
+using PoolLockFree = PoolBackend<LockFree>;
+
+/*
+ * Patterns
+ */
+template<typename Backend>
+void ThreadLocalChurnBM(benchmark::State &state)
+{
+	std::vector<typename Backend::Handle> handles;
+	handles.reserve(batchSize);
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < batchSize; ++i) { handles.push_back(Backend::Allocate()); }
+		// Every other one first so the free lists aren't just the allocation order reversed
+		for (std::size_t i(0); i < batchSize; i += 2) { handles[i].reset(); }
+		handles.clear();
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batchSize));
+}
+
+// Batches every thread has allocated but nobody has freed yet
+template<typename Handle>
+class BatchExchange {
+public:
+	auto Push(std::vector<Handle> &&batch) -> void
+	{
+		std::scoped_lock lock(mutex_);
+		batches_.push_back(std::move(batch));
+	}
+
+	auto Pop() -> std::optional<std::vector<Handle>>
+	{
+		std::scoped_lock lock(mutex_);
+		if (batches_.empty()) { return std::nullopt; }
+		std::optional<std::vector<Handle>> ret(std::move(batches_.front()));
+		batches_.pop_front();
+		return ret;
+	}
+
+private:
+	std::mutex mutex_;
+	std::deque<std::vector<Handle>> batches_;
+};
+
+template<typename Backend>
+void CrossThreadFreeBM(benchmark::State &state)
+{
+	using Handle = typename Backend::Handle;
+	// Constructed after the backend so it is destroyed (and frees anything left) before it
+	static auto &exchange([]() -> BatchExchange<Handle> & {
+		Backend::Allocate();
+		static BatchExchange<Handle> exchange;
+		return exchange;
+	}());
+
+	for (auto _ : state) {
+		std::vector<Handle> batch;
+		batch.reserve(batchSize);
+		for (std::size_t i(0); i < batchSize; ++i) { batch.push_back(Backend::Allocate()); }
+		exchange.Push(std::move(batch));
+
+		// Oldest first, which with more than one thread is almost always someone else's
+		exchange.Pop();
+	}
+
+	// Every thread has stopped allocating by now
+	while (exchange.Pop()) {}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batchSize));
+}
+
+template<typename Handle>
+struct SharedTable {
+	std::vector<Handle> handles;
+	// Striped so threads only contend when they pick nearby elements
+	std::array<std::mutex, 64> locks;
+};
+
+template<typename Backend>
+void SharedRandomReplaceBM(benchmark::State &state)
+{
+	using Handle = typename Backend::Handle;
+	static auto &table([]() -> SharedTable<Handle> & {
+		static SharedTable<Handle> table;
+		for (std::size_t i(0); i < sharedTableSize; ++i) {
+			table.handles.push_back(Backend::Allocate());
+		}
+		return table;
+	}());
+
+	std::mt19937 gen(static_cast<std::mt19937::result_type>(state.thread_index()));
+	std::uniform_int_distribution<std::size_t> dis(0, sharedTableSize - 1);
+
+	for (auto _ : state) {
+		for (std::size_t i(0); i < replacesPerIteration; ++i) {
+			const auto location(dis(gen));
+			std::scoped_lock lock(table.locks[location % table.locks.size()]);
+			table.handles[location] = Backend::Allocate();
+		}
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * replacesPerIteration));
+}
+
+const auto maxThreads(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+
+#define HGALLOC_MT_BENCHMARK(pattern, backend)                                                     \
+	BENCHMARK_TEMPLATE(pattern, backend)->ThreadRange(1, maxThreads)->UseRealTime()
+
+HGALLOC_MT_BENCHMARK(ThreadLocalChurnBM, MallocBackend);
+HGALLOC_MT_BENCHMARK(ThreadLocalChurnBM, PmrSynchronized);
+HGALLOC_MT_BENCHMARK(ThreadLocalChurnBM, PmrUnsynchronizedPerThread);
+HGALLOC_MT_BENCHMARK(ThreadLocalChurnBM, PoolThreadCached);
+HGALLOC_MT_BENCHMARK(ThreadLocalChurnBM, PoolLockFree);
+
+HGALLOC_MT_BENCHMARK(CrossThreadFreeBM, MallocBackend);
+HGALLOC_MT_BENCHMARK(CrossThreadFreeBM, PmrSynchronized);
+HGALLOC_MT_BENCHMARK(CrossThreadFreeBM, PmrUnsynchronizedLocked);
+HGALLOC_MT_BENCHMARK(CrossThreadFreeBM, PoolThreadCached);
+HGALLOC_MT_BENCHMARK(CrossThreadFreeBM, PoolLockFree);
+
+HGALLOC_MT_BENCHMARK(SharedRandomReplaceBM, MallocBackend);
+HGALLOC_MT_BENCHMARK(SharedRandomReplaceBM, PmrSynchronized);
+HGALLOC_MT_BENCHMARK(SharedRandomReplaceBM, PmrUnsynchronizedLocked);
+HGALLOC_MT_BENCHMARK(SharedRandomReplaceBM, PoolThreadCached);
+HGALLOC_MT_BENCHMARK(SharedRandomReplaceBM, PoolLockFree);
+
+}// namespace hgalloc
+
+BENCHMARK_MAIN();
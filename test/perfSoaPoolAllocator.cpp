@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * test/perfSoaPoolAllocator.cpp
+ *		Summing one field of a pool full of 200 byte records, stored as structs in a
+ *		GrowingGlobalPoolAllocator and as columns in a SoaPoolAllocator.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../SoaPoolAllocator.h"
+
+#include <array>
+#include <numeric>
+#include <vector>
+
+namespace hgalloc {
+
+constexpr std::size_t numElements{1'000'000};
+constexpr std::size_t bucketSize{16'384};
+
+struct Quote {
+	double price_;
+	double size_;
+	std::array<char, 184> rest_;
+};
+static_assert(sizeof(Quote) == 200);
+
+void StructScanBM(benchmark::State &state)
+{
+	using Allocator = GrowingGlobalPoolAllocator<Quote, bucketSize>;
+	Allocator allocator{numElements};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < numElements; ++i) {
+		ptrs.push_back(allocator.Allocate(Quote{static_cast<double>(i), 1.0, {}}));
+	}
+
+	for (auto _ : state) {
+		double sum(0);
+		for (FourBytePtr i(0); i < numElements; ++i) { sum += Allocator::AddressOf(i)->price_; }
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numElements));
+}
+BENCHMARK(StructScanBM)->Unit(benchmark::kMicrosecond);
+
+void ColumnScanBM(benchmark::State &state)
+{
+	using Allocator =
+			SoaPoolAllocator<std::tuple<double, double, std::array<char, 184>>, bucketSize>;
+	Allocator allocator{numElements};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < numElements; ++i) {
+		ptrs.push_back(allocator.Allocate(static_cast<double>(i), 1.0, {}));
+	}
+
+	for (auto _ : state) {
+		double sum(0);
+		for (std::size_t bucketNum(0); bucketNum < Allocator::NumOfBuckets(); ++bucketNum) {
+			if (!Allocator::IsBucketCreated(bucketNum)) { continue; }
+			const auto prices(Allocator::Column<0>(bucketNum));
+			sum = std::accumulate(prices.begin(), prices.end(), sum);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * numElements));
+}
+BENCHMARK(ColumnScanBM)->Unit(benchmark::kMicrosecond);
+
+}// namespace hgalloc
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * test/perfTailLatency.cpp
+ *		Times every single Allocate and Free and reports percentiles rather than the mean, as the
+ *		costs we care about are rare: creating a bucket, evicting one every <bucketSize> frees and
+ *		finding a free list. Each benchmark reports <op>P50Ns, P99Ns, P999Ns and MaxNs counters,
+ *		the time per iteration includes the timing overhead so isn't comparable with
+ *		perfGrowingGlobalPoolAllocator.
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "../GrowingGlobalPoolAllocator_impl.h"
+#include "LatencyHistogram.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hgalloc {
+
+struct BigType {
+	char var_[200];
+};
+
+constexpr std::size_t runSize{100'000};
+constexpr std::size_t numRandomReplaces{1'000};
+
+auto ReportPercentiles(benchmark::State &state, const std::string &name,
+					   const LatencyHistogram &histogram) -> void
+{
+	const auto nanoseconds([](std::uint64_t ticks) { return LatencyClock::ToNanoseconds(ticks); });
+	state.counters[name + "P50Ns"] = nanoseconds(histogram.Percentile(50));
+	state.counters[name + "P99Ns"] = nanoseconds(histogram.Percentile(99));
+	state.counters[name + "P999Ns"] = nanoseconds(histogram.Percentile(99.9));
+	state.counters[name + "MaxNs"] = nanoseconds(histogram.Max());
+}
+
+// Makers for the pools and the unique_ptr baseline, so the scenarios below don't care which
+// they are using
+struct UniquePtrMaker {
+	explicit UniquePtrMaker(std::size_t) {}
+	auto Make() -> std::unique_ptr<BigType> { return std::make_unique<BigType>(); }
+	auto Maintain() -> void {}
+};
+
+template<typename Allocator>
+struct PoolMaker {
+	explicit PoolMaker(std::size_t maxElements) : allocator_(maxElements) {}
+	auto Make() -> typename Allocator::PtrType { return allocator_.Allocate(); }
+	auto Maintain() -> void { allocator_.Maintain(); }
+
+	Allocator allocator_;
+};
+
+template<typename... Options>
+using BigTypePool = PoolMaker<GrowingGlobalPoolAllocator<BigType, 16'384, Options...>>;
+
+// Grows to runSize then frees everything newest first, so every bucket is created and evicted
+// once per iteration. Maintain() is called untimed every 1024 calls, it only does anything with
+// DeferredMaintenance.
+template<typename Maker>
+void GrowAndShrinkTailLatencyBM(benchmark::State &state)
+{
+	Maker maker{runSize};
+	std::vector<decltype(maker.Make())> ptrs;
+	ptrs.reserve(runSize);
+
+	LatencyHistogram allocate;
+	LatencyHistogram free;
+	for (auto _ : state) {
+		for (std::size_t i(0); i < runSize; ++i) {
+			if (i % 1'024 == 0) { maker.Maintain(); }
+
+			const auto start(LatencyClock::Now());
+			auto ptr(maker.Make());
+			allocate.Record(LatencyClock::Now() - start);
+			ptrs.push_back(std::move(ptr));
+		}
+		for (std::size_t i(0); i < runSize; ++i) {
+			if (i % 1'024 == 0) { maker.Maintain(); }
+
+			const auto start(LatencyClock::Now());
+			ptrs.back().reset();
+			free.Record(LatencyClock::Now() - start);
+			ptrs.pop_back();
+		}
+	}
+
+	ReportPercentiles(state, "allocate", allocate);
+	ReportPercentiles(state, "free", free);
+}
+BENCHMARK_TEMPLATE(GrowAndShrinkTailLatencyBM, UniquePtrMaker);
+BENCHMARK_TEMPLATE(GrowAndShrinkTailLatencyBM, BigTypePool<>);
+BENCHMARK_TEMPLATE(GrowAndShrinkTailLatencyBM, BigTypePool<DeferredMaintenance>);
+BENCHMARK_TEMPLATE(GrowAndShrinkTailLatencyBM, BigTypePool<ReservedAddressSpace>);
+
+// A full pool where random elements are freed and replaced, so allocations come off free lists
+// scattered across every bucket
+template<typename Maker>
+void RandomReplaceTailLatencyBM(benchmark::State &state)
+{
+	Maker maker{runSize};
+	std::vector<decltype(maker.Make())> ptrs;
+	ptrs.reserve(runSize);
+	for (std::size_t i(0); i < runSize; ++i) { ptrs.push_back(maker.Make()); }
+
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<std::size_t> dis(0, runSize - 1);
+	std::vector<std::size_t> locations(numRandomReplaces);
+
+	LatencyHistogram allocate;
+	LatencyHistogram free;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (auto &location : locations) { location = dis(gen); }
+		state.ResumeTiming();
+
+		for (const auto location : locations) {
+			const auto start(LatencyClock::Now());
+			ptrs[location].reset();
+			free.Record(LatencyClock::Now() - start);
+		}
+		for (const auto location : locations) {
+			const auto start(LatencyClock::Now());
+			auto ptr(maker.Make());
+			allocate.Record(LatencyClock::Now() - start);
+			ptrs[location] = std::move(ptr);
+		}
+	}
+
+	ReportPercentiles(state, "allocate", allocate);
+	ReportPercentiles(state, "free", free);
+}
+BENCHMARK_TEMPLATE(RandomReplaceTailLatencyBM, UniquePtrMaker);
+BENCHMARK_TEMPLATE(RandomReplaceTailLatencyBM, BigTypePool<>);
+BENCHMARK_TEMPLATE(RandomReplaceTailLatencyBM, BigTypePool<ReservedAddressSpace>);
+
+}// namespace hgalloc
+
+BENCHMARK_MAIN();
@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testCompactHashMap.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../CompactHashMap.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+using IntMap = CompactHashMap<std::uint64_t, std::uint32_t, 256>;
+
+struct CompactHashMapTest : ::testing::Test {
+	IntMap::Pool pool{10'000};
+	IntMap map{pool};
+};
+
+TEST_F(CompactHashMapTest, NodesAreTheKeyValueAndOneIndex)
+{
+	static_assert(sizeof(IntMap::Node) == 16);
+}
+
+TEST_F(CompactHashMapTest, StartsEmpty)
+{
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(map.begin(), map.end());
+	ASSERT_EQ(map.find(1), map.end());
+	ASSERT_EQ(map.erase(1), 0);
+}
+
+TEST_F(CompactHashMapTest, InsertFindErase)
+{
+	ASSERT_TRUE(map.insert({1, 10}).second);
+	ASSERT_FALSE(map.insert({1, 20}).second);
+	ASSERT_TRUE(map.try_emplace(2, 20u).second);
+	map[3] = 30;
+
+	ASSERT_EQ(map.size(), 3);
+	ASSERT_EQ(map.find(1)->second, 10);
+	ASSERT_EQ(map[2], 20);
+	ASSERT_TRUE(map.contains(3));
+
+	ASSERT_EQ(map.erase(2), 1);
+	ASSERT_FALSE(map.contains(2));
+	ASSERT_EQ(map.size(), 2);
+	ASSERT_EQ(pool.Size(), 2);
+}
+
+TEST_F(CompactHashMapTest, GrowsAndKeepsEverything)
+{
+	for (std::uint64_t i(0); i < 5'000; ++i) { map[i * 7] = static_cast<std::uint32_t>(i); }
+	ASSERT_GE(map.bucket_count(), map.size());
+	for (std::uint64_t i(0); i < 5'000; ++i) { ASSERT_EQ(map.find(i * 7)->second, i); }
+}
+
+TEST_F(CompactHashMapTest, ReserveStopsRehashing)
+{
+	map.reserve(1'000);
+	const auto buckets(map.bucket_count());
+	ASSERT_GE(buckets, 1'000);
+	for (std::uint64_t i(0); i < 1'000; ++i) { map[i] = 0; }
+	ASSERT_EQ(map.bucket_count(), buckets);
+}
+
+TEST_F(CompactHashMapTest, IteratesEveryElementOnce)
+{
+	for (std::uint64_t i(0); i < 1'000; ++i) { map[i] = static_cast<std::uint32_t>(i); }
+
+	std::vector<bool> seen(1'000);
+	for (const auto &[key, value] : map) {
+		ASSERT_EQ(key, value);
+		ASSERT_FALSE(seen[key]);
+		seen[key] = true;
+	}
+	ASSERT_TRUE(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }));
+}
+
+TEST_F(CompactHashMapTest, EraseWhileIterating)
+{
+	for (std::uint64_t i(0); i < 1'000; ++i) { map[i] = static_cast<std::uint32_t>(i); }
+
+	for (auto it(map.begin()); it != map.end();) {
+		it = it->first % 3 == 0 ? map.erase(it) : std::next(it);
+	}
+	ASSERT_EQ(map.size(), 666);
+	for (const auto &[key, value] : map) { ASSERT_NE(key % 3, 0); }
+}
+
+TEST_F(CompactHashMapTest, MatchesStdMapUnderRandomOperations)
+{
+	std::map<std::uint64_t, std::uint32_t> expected;
+	std::mt19937 gen(11);
+	std::uniform_int_distribution<std::uint64_t> keys(0, 3'000);
+	for (std::uint32_t i(0); i < 20'000; ++i) {
+		const auto key(keys(gen));
+		if (gen() % 3 == 0) {
+			ASSERT_EQ(map.erase(key), expected.erase(key));
+		} else {
+			map[key] = i;
+			expected[key] = i;
+		}
+	}
+	ASSERT_EQ(map.size(), expected.size());
+	ASSERT_EQ(pool.Size(), expected.size());
+	for (const auto &[key, value] : expected) { ASSERT_EQ(map.find(key)->second, value); }
+}
+
+TEST_F(CompactHashMapTest, MovesAndClears)
+{
+	for (std::uint64_t i(0); i < 100; ++i) { map[i] = 1; }
+	IntMap moved(std::move(map));
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(moved.size(), 100);
+	ASSERT_TRUE(moved.contains(50));
+
+	map[1] = 2;
+	moved = std::move(map);
+	ASSERT_EQ(moved.size(), 1);
+	ASSERT_EQ(pool.Size(), 1);
+
+	moved.clear();
+	ASSERT_EQ(pool.Size(), 0);
+}
+
+TEST(CompactHashMap, StringKeysAndDestroysValues)
+{
+	using Map = CompactHashMap<std::string, std::shared_ptr<int>, 16>;
+	Map::Pool pool{100};
+	auto value(std::make_shared<int>(1));
+	{
+		Map map{pool};
+		for (int i(0); i < 50; ++i) { map[std::to_string(i)] = value; }
+		ASSERT_EQ(value.use_count(), 51);
+		map.erase("10");
+		ASSERT_EQ(value.use_count(), 50);
+		ASSERT_EQ(map.find("20")->second, value);
+	}
+	ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST(CompactHashMap, FullPoolThrows)
+{
+	IntMap::Pool pool{10};
+	IntMap map{pool};
+	for (std::uint64_t i(0); i < 10; ++i) { map[i] = 0; }
+	ASSERT_THROW(map[10] = 0, std::bad_alloc);
+	ASSERT_EQ(map.size(), 10);
+}
+
+}// namespace hgalloc
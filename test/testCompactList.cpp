@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testCompactList.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../CompactList.h"
+
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+using IntList = CompactList<std::uint64_t, 64>;
+
+struct CompactListTest : ::testing::Test {
+	IntList::Pool pool{1'000};
+	IntList list{pool};
+};
+
+TEST_F(CompactListTest, NodesAreTheValuePlusTwoIndices)
+{
+	static_assert(sizeof(IntList::Node) == sizeof(std::uint64_t) + 2 * sizeof(FourBytePtr));
+}
+
+TEST_F(CompactListTest, StartsEmpty)
+{
+	ASSERT_TRUE(list.empty());
+	ASSERT_EQ(list.size(), 0);
+	ASSERT_EQ(list.begin(), list.end());
+}
+
+TEST_F(CompactListTest, PushAndPopBothEnds)
+{
+	list.push_back(2);
+	list.push_front(1);
+	list.emplace_back(3);
+
+	ASSERT_EQ(list.size(), 3);
+	ASSERT_EQ(list.front(), 1);
+	ASSERT_EQ(list.back(), 3);
+
+	list.pop_front();
+	ASSERT_EQ(list.front(), 2);
+	list.pop_back();
+	ASSERT_EQ(list.back(), 2);
+	list.pop_back();
+	ASSERT_TRUE(list.empty());
+	ASSERT_EQ(pool.Size(), 0);
+}
+
+TEST_F(CompactListTest, IteratesBothWays)
+{
+	for (std::uint64_t i(0); i < 10; ++i) { list.push_back(i); }
+
+	std::uint64_t expected(0);
+	for (const auto value : list) { ASSERT_EQ(value, expected++); }
+
+	auto it(list.end());
+	for (std::uint64_t i(10); i > 0; --i) { ASSERT_EQ(*--it, i - 1); }
+	ASSERT_EQ(it, list.begin());
+}
+
+TEST_F(CompactListTest, InsertAndEraseInTheMiddle)
+{
+	for (std::uint64_t i(0); i < 10; ++i) { list.push_back(i); }
+
+	auto it(std::next(list.begin(), 5));
+	it = list.erase(it);
+	ASSERT_EQ(*it, 6);
+	it = list.emplace(it, 100);
+	ASSERT_EQ(*std::prev(it), 4);
+	ASSERT_EQ(*std::next(it), 6);
+	ASSERT_EQ(list.size(), 10);
+}
+
+TEST_F(CompactListTest, MatchesStdListUnderRandomOperations)
+{
+	std::list<std::uint64_t> expected;
+	std::mt19937 gen(7);
+	for (std::uint64_t i(0); i < 5'000; ++i) {
+		switch (gen() % 4) {
+			case 0:
+				list.push_front(i);
+				expected.push_front(i);
+				break;
+			case 1:
+				list.push_back(i);
+				expected.push_back(i);
+				break;
+			case 2:
+				if (!expected.empty()) {
+					list.pop_front();
+					expected.pop_front();
+				}
+				break;
+			default:
+				if (!expected.empty()) {
+					list.pop_back();
+					expected.pop_back();
+				}
+				break;
+		}
+	}
+	ASSERT_EQ(list.size(), expected.size());
+	ASSERT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+	ASSERT_EQ(pool.Size(), expected.size());
+}
+
+TEST_F(CompactListTest, ListsShareAPool)
+{
+	IntList other{pool};
+	for (std::uint64_t i(0); i < 100; ++i) {
+		list.push_back(i);
+		other.push_back(i * 2);
+	}
+	ASSERT_EQ(pool.Size(), 200);
+
+	IntList moved(std::move(other));
+	ASSERT_TRUE(other.empty());
+	ASSERT_EQ(moved.back(), 198);
+
+	moved = std::move(list);
+	ASSERT_EQ(moved.back(), 99);
+	ASSERT_EQ(pool.Size(), 100);
+
+	moved.clear();
+	ASSERT_EQ(pool.Size(), 0);
+}
+
+TEST_F(CompactListTest, FullPoolThrows)
+{
+	for (std::uint64_t i(0); i < 1'000; ++i) { list.push_back(i); }
+	ASSERT_THROW(list.push_back(0), std::bad_alloc);
+	ASSERT_EQ(list.size(), 1'000);
+}
+
+TEST(CompactList, DestroysValues)
+{
+	using StringList = CompactList<std::shared_ptr<int>, 16>;
+	StringList::Pool pool{100};
+	auto value(std::make_shared<int>(1));
+	{
+		StringList list{pool};
+		for (int i(0); i < 50; ++i) { list.push_back(value); }
+		ASSERT_EQ(value.use_count(), 51);
+		list.pop_back();
+		ASSERT_EQ(value.use_count(), 50);
+	}
+	ASSERT_EQ(value.use_count(), 1);
+}
+
+}// namespace hgalloc
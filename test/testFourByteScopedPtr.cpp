@@ -124,6 +124,15 @@ TEST_F(BufferOfStrings, GoesOutOfScope_CallsFree)
 	}
 }
 
+TEST_F(BufferOfStrings, Release_DoesntCallFree)
+{
+	const auto index(1);
+	EXPECT_CALL(allocator, FreeMock(_, _)).Times(0);
+	Ptr a(index);
+	ASSERT_EQ(a.release(), index);
+	ASSERT_EQ(nullptr, a);
+}
+
 TEST_F(BufferOfStrings, Reset_CallsFreeOnce)
 {
 	const auto index(0);
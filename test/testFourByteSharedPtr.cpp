@@ -0,0 +1,172 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testFourByteSharedPtr.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../FourByteSharedPtr.h"
+#include "../GrowingGlobalPoolAllocator_impl.h"
+
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+template<typename Allocator>
+struct FourByteSharedPtrTest : ::testing::Test {
+	Allocator allocator{100};
+};
+
+using SharedAllocators = ::testing::Types<
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, RefCounted>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, RefCounted, PackedLayout>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, RefCounted, ReservedAddressSpace>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, AtomicRefCounted, LockFree>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, AtomicRefCounted, ThreadCached<4>>>;
+TYPED_TEST_SUITE(FourByteSharedPtrTest, SharedAllocators);
+
+TYPED_TEST(FourByteSharedPtrTest, IsFourBytes)
+{
+	static_assert(sizeof(typename TypeParam::SharedPtrType) == 4);
+}
+
+TYPED_TEST(FourByteSharedPtrTest, NullByDefault)
+{
+	const typename TypeParam::SharedPtrType ptr;
+	ASSERT_EQ(nullptr, ptr);
+	ASSERT_EQ(ptr.get(), nullptr);
+	ASSERT_EQ(ptr.use_count(), 0);
+
+	auto copy(ptr);
+	ASSERT_EQ(nullptr, copy);
+	ASSERT_EQ(nullptr, TypeParam::Share(TypeParam::PtrType::CreateNullPtr()));
+}
+
+TYPED_TEST(FourByteSharedPtrTest, CopiesShareTheElement)
+{
+	auto ptr(this->allocator.AllocateShared(5));
+	ASSERT_NE(nullptr, ptr);
+	ASSERT_EQ(ptr.use_count(), 1);
+	ASSERT_EQ(*ptr, 5);
+
+	auto copy(ptr);
+	ASSERT_EQ(copy, ptr);
+	ASSERT_EQ(copy.get(), ptr.get());
+	ASSERT_EQ(ptr.use_count(), 2);
+	*copy = 6;
+	ASSERT_EQ(*ptr, 6);
+
+	// Only the last one frees it
+	ptr.reset();
+	ASSERT_EQ(nullptr, ptr);
+	ASSERT_EQ(copy.use_count(), 1);
+	ASSERT_EQ(this->allocator.Size(), 1);
+	copy.reset();
+	ASSERT_EQ(this->allocator.Size(), 0);
+}
+
+TYPED_TEST(FourByteSharedPtrTest, AssignmentAndMoves_KeepTheCountRight)
+{
+	auto first(this->allocator.AllocateShared(1));
+	auto second(this->allocator.AllocateShared(2));
+
+	// Assigning drops the old element and shares the new one
+	second = first;
+	ASSERT_EQ(this->allocator.Size(), 1);
+	ASSERT_EQ(first.use_count(), 2);
+
+	// Assigning a handle to itself or a copy of what it has changes nothing
+	auto &alias(second);
+	second = alias;
+	second = first;
+	ASSERT_EQ(first.use_count(), 2);
+	ASSERT_EQ(*second, 1);
+
+	auto moved(std::move(second));
+	ASSERT_EQ(nullptr, second);
+	ASSERT_EQ(first.use_count(), 2);
+	first = std::move(moved);
+	ASSERT_EQ(first.use_count(), 1);
+	ASSERT_EQ(this->allocator.Size(), 1);
+}
+
+TYPED_TEST(FourByteSharedPtrTest, Share_TakesOverAUniqueHandle)
+{
+	auto unique(this->allocator.Allocate(7));
+	const auto index(unique.Index());
+	auto shared(TypeParam::Share(std::move(unique)));
+	ASSERT_EQ(nullptr, unique);
+	ASSERT_EQ(shared.Index(), index);
+	ASSERT_EQ(shared.use_count(), 1);
+	ASSERT_EQ(*shared, 7);
+}
+
+TYPED_TEST(FourByteSharedPtrTest, ManyOwners_FreeEverythingAtTheEnd)
+{
+	std::vector<typename TypeParam::SharedPtrType> owners;
+	for (std::uint64_t i(0); i < 100; ++i) {
+		owners.push_back(this->allocator.AllocateShared(i));
+		owners.push_back(owners.back());
+	}
+	ASSERT_EQ(this->allocator.Size(), 100);
+	ASSERT_EQ(nullptr, this->allocator.AllocateShared(0));
+
+	// Dropping every other handle leaves one owner for each element
+	for (std::size_t i(0); i < owners.size(); i += 2) { owners[i].reset(); }
+	ASSERT_EQ(this->allocator.Size(), 100);
+	for (std::size_t i(1); i < owners.size(); i += 2) { ASSERT_EQ(*owners[i], i / 2); }
+
+	owners.clear();
+	ASSERT_EQ(this->allocator.Size(), 0);
+
+	// The counts of reused elements start again from one
+	auto ptr(this->allocator.AllocateShared(0));
+	ASSERT_EQ(ptr.use_count(), 1);
+}
+
+TEST(FourByteSharedPtrAtomicTest, CopiesOnManyThreads)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 64, AtomicRefCounted, LockFree>;
+	constexpr std::size_t numOfElements(256);
+	constexpr std::size_t numOfThreads(4);
+	Allocator allocator{numOfElements};
+
+	std::vector<Allocator::SharedPtrType> shared;
+	for (std::uint64_t i(0); i < numOfElements; ++i) {
+		shared.push_back(allocator.AllocateShared(i));
+	}
+
+	// Every thread takes and drops copies of every element, racing on the counts
+	{
+		std::vector<std::jthread> threads;
+		for (std::size_t t(0); t < numOfThreads; ++t) {
+			threads.emplace_back([&shared] {
+				for (std::size_t runs(0); runs < 100; ++runs) {
+					std::vector<Allocator::SharedPtrType> copies(shared.begin(), shared.end());
+					for (std::size_t i(0); i < copies.size(); ++i) { EXPECT_EQ(*copies[i], i); }
+				}
+			});
+		}
+	}
+	for (const auto &ptr : shared) { ASSERT_EQ(ptr.use_count(), 1); }
+
+	// Hand the last references to other threads, who free the elements
+	{
+		std::vector<std::jthread> threads;
+		for (std::size_t t(0); t < numOfThreads; ++t) {
+			std::vector<Allocator::SharedPtrType> mine;
+			for (std::size_t i(t); i < shared.size(); i += numOfThreads) {
+				mine.push_back(std::move(shared[i]));
+			}
+			threads.emplace_back([mine = std::move(mine)]() mutable { mine.clear(); });
+		}
+	}
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+}// namespace hgalloc
@@ -0,0 +1,187 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testFourByteWeakPtr.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../FourByteWeakPtr.h"
+#include "../GrowingGlobalPoolAllocator_impl.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+template<typename Allocator>
+struct FourByteWeakPtrTest : ::testing::Test {
+	Allocator allocator{100};
+};
+
+using WeakAllocators = ::testing::Types<
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<8>>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<12>, AnyBucketEviction>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<24>, PackedLayout>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<8>, LockFree>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<8>, ThreadCached<4>>>;
+TYPED_TEST_SUITE(FourByteWeakPtrTest, WeakAllocators);
+
+TYPED_TEST(FourByteWeakPtrTest, IsFourBytes)
+{
+	static_assert(sizeof(typename TypeParam::WeakPtrType) == 4);
+}
+
+TYPED_TEST(FourByteWeakPtrTest, NullByDefault)
+{
+	using WeakPtr = typename TypeParam::WeakPtrType;
+	const WeakPtr weak;
+	ASSERT_EQ(weak.lock(), nullptr);
+	ASSERT_TRUE(weak.expired());
+	ASSERT_EQ(weak.Value(), WeakPtr::NULL_PTR);
+
+	const WeakPtr fromNull(TypeParam::PtrType::CreateNullPtr());
+	ASSERT_EQ(fromNull, weak);
+}
+
+TYPED_TEST(FourByteWeakPtrTest, LocksWhileTheElementIsLive)
+{
+	using WeakPtr = typename TypeParam::WeakPtrType;
+	auto ptr(this->allocator.Allocate(5));
+	const WeakPtr weak(ptr);
+	ASSERT_EQ(weak.lock(), ptr.get());
+	ASSERT_FALSE(weak.expired());
+	ASSERT_EQ(*weak.lock(), 5);
+
+	ptr.reset();
+	ASSERT_EQ(weak.lock(), nullptr);
+	ASSERT_TRUE(weak.expired());
+}
+
+TYPED_TEST(FourByteWeakPtrTest, ReusedElement_StaysExpired)
+{
+	using WeakPtr = typename TypeParam::WeakPtrType;
+	auto ptr(this->allocator.Allocate(1));
+	const FourBytePtr index(ptr.Index());
+	const WeakPtr weak(ptr);
+	ptr.reset();
+
+	// Keep going until the element is handed out again, the old weak handle mustn't see it
+	std::vector<typename TypeParam::PtrType> ptrs;
+	while (ptrs.empty() || ptrs.back().Index() != index) {
+		ptrs.push_back(this->allocator.Allocate(2));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+	ASSERT_EQ(weak.lock(), nullptr);
+
+	const WeakPtr reused(ptrs.back());
+	ASSERT_NE(reused, weak);
+	ASSERT_EQ(*reused.lock(), 2);
+}
+
+TYPED_TEST(FourByteWeakPtrTest, EvictedBucket_StaysExpired)
+{
+	using WeakPtr = typename TypeParam::WeakPtrType;
+	std::vector<typename TypeParam::PtrType> ptrs;
+	std::vector<WeakPtr> weaks;
+	for (std::uint64_t i(0); i < 100; ++i) {
+		ptrs.push_back(this->allocator.Allocate(i));
+		weaks.emplace_back(ptrs.back());
+	}
+
+	// Frees from the top down so buckets are evicted, then fills them again
+	while (!ptrs.empty()) { ptrs.pop_back(); }
+	for (std::uint64_t i(0); i < 100; ++i) { ptrs.push_back(this->allocator.Allocate(i)); }
+	for (const auto &weak : weaks) { ASSERT_TRUE(weak.expired()); }
+	for (const auto &ptr : ptrs) { ASSERT_EQ(WeakPtr(ptr).lock(), ptr.get()); }
+}
+
+TYPED_TEST(FourByteWeakPtrTest, FreeN_ExpiresEveryHandle)
+{
+	using WeakPtr = typename TypeParam::WeakPtrType;
+	std::vector<typename TypeParam::PtrType> ptrs;
+	ASSERT_EQ(this->allocator.AllocateN(20, std::back_inserter(ptrs), 0), 20);
+	std::vector<WeakPtr> weaks(ptrs.begin(), ptrs.end());
+	this->allocator.FreeN(std::span(ptrs).subspan(0, 10));
+	for (std::size_t i(0); i < weaks.size(); ++i) { ASSERT_EQ(weaks[i].expired(), i < 10); }
+}
+
+TEST(FourByteWeakPtrGenerationTest, WrapsAfterEveryGeneration)
+{
+	// With one generation bit a weak handle sees the element again every second reuse
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<1>>;
+	Allocator allocator{8};
+	auto ptr(allocator.Allocate(1));
+	const Allocator::WeakPtrType weak(ptr);
+	ASSERT_EQ(weak.Value(), ptr.Index());
+
+	ptr.reset();
+	ptr = allocator.Allocate(2);
+	ASSERT_EQ(weak.Value(), ptr.Index());
+	ASSERT_TRUE(weak.expired());
+	ASSERT_EQ(Allocator::WeakPtrType(ptr).Value(), ptr.Index() | (1U << 31));
+
+	ptr.reset();
+	ptr = allocator.Allocate(3);
+	ASSERT_EQ(weak.lock(), ptr.get());
+}
+
+TEST(FourByteWeakPtrGenerationTest, MaxElementsLeavesRoomForTheGeneration)
+{
+	static_assert(GrowingGlobalPoolAllocator<std::uint64_t, 8>::MAX_ELEMENTS == (1ULL << 32) - 1);
+	static_assert(GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<8>>::MAX_ELEMENTS ==
+				  (1U << 24) - 1);
+	static_assert(GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<20>,
+											 TwoByteHandles>::MAX_ELEMENTS == (1U << 12) - 1);
+	static_assert(GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<8>,
+											 TwoByteHandles>::MAX_ELEMENTS == (1U << 16) - 1);
+
+	// The most a weak handle can index still works, right up to the top element
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, Generations<24>>;
+	Allocator allocator{MaxElements<Allocator::MAX_ELEMENTS>{}};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < Allocator::MAX_ELEMENTS; ++i) {
+		ptrs.push_back(allocator.Allocate(i));
+	}
+	ASSERT_EQ(nullptr, allocator.Allocate(0));
+	const Allocator::WeakPtrType weak(ptrs.back());
+	ASSERT_NE(weak.Value(), Allocator::WeakPtrType::NULL_PTR);
+	ASSERT_EQ(weak.lock(), ptrs.back().get());
+}
+
+TEST(FourByteWeakPtrGenerationTest, ThreadsFreeingTheirOwnElements)
+{
+	using Allocator =
+			GrowingGlobalPoolAllocator<std::uint64_t, 64, Generations<8>, ThreadCached<8>>;
+	constexpr std::size_t numOfThreads(4);
+	constexpr std::size_t perThread(1'000);
+	Allocator allocator{numOfThreads * perThread};
+
+	std::vector<std::jthread> threads;
+	for (std::size_t t(0); t < numOfThreads; ++t) {
+		threads.emplace_back([&allocator] {
+			for (std::uint64_t runs(0); runs < 20; ++runs) {
+				std::vector<Allocator::PtrType> ptrs;
+				std::vector<Allocator::WeakPtrType> weaks;
+				for (std::size_t i(0); i < perThread; ++i) {
+					ptrs.push_back(allocator.Allocate(runs));
+					weaks.emplace_back(ptrs.back());
+				}
+				for (std::size_t i(0); i < perThread; i += 2) { ptrs[i].reset(); }
+				for (std::size_t i(0); i < perThread; ++i) {
+					const auto *const element(weaks[i].lock());
+					if (i % 2 == 0) {
+						EXPECT_EQ(element, nullptr);
+					} else {
+						EXPECT_EQ(element, ptrs[i].get());
+						EXPECT_EQ(*element, runs);
+					}
+				}
+			}
+		});
+	}
+}
+
+}// namespace hgalloc
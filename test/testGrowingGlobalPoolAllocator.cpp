@@ -7,16 +7,74 @@
 
 #include "../GrowingGlobalPoolAllocator.h"
 #include "../GrowingGlobalPoolAllocator_impl.h"
-
+#include "../PoolMaintainer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
 #include <random>
+#include <set>
+#include <stdexcept>
+#include <span>
+#include <thread>
+#include <unordered_set>
 
 #include <sys/sysinfo.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 
 namespace hgalloc {
 
+// Fills the pool, then frees all but about 1 in keepOneIn elements at random and fills it back up
+// again for a number of runs, checking every surviving element kept its value. Leaves ptrs with
+// one slot per element of the pool, holding the survivors of the last run.
+template<typename Allocator>
+auto RandomFreesAndRefills(Allocator &allocator, std::vector<typename Allocator::PtrType> &ptrs,
+						   int keepOneIn) -> void
+{
+	using Value = typename Allocator::Type;
+
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<> dis(0, keepOneIn - 1);
+
+	ptrs.clear();
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+		ptrs.push_back(Allocator::PtrType::CreateNullPtr());
+	}
+	std::vector<Value> values(allocator.Capacity());
+	for (std::size_t runs(0); runs < 20; ++runs) {
+		for (std::size_t i(0); i < ptrs.size(); ++i) {
+			if (nullptr == ptrs[i]) {
+				values[i] = static_cast<Value>(runs * 1000 + i);
+				ptrs[i] = allocator.Allocate(values[i]);
+				ASSERT_NE(nullptr, ptrs[i]);
+				ASSERT_EQ(Allocator::AddressOf(ptrs[i].Index()), ptrs[i].get());
+			}
+		}
+		ASSERT_EQ(allocator.Size(), allocator.Capacity());
+
+		std::size_t live(0);
+		for (auto &ptr : ptrs) {
+			if (dis(gen) != 0) {
+				ptr.reset();
+			} else {
+				++live;
+			}
+		}
+		allocator.Maintain();
+		ASSERT_EQ(allocator.Size(), live);
+
+		for (std::size_t i(0); i < ptrs.size(); ++i) {
+			if (nullptr != ptrs[i]) { ASSERT_EQ(*ptrs[i], values[i]); }
+		}
+	}
+}
+
 struct IntAllocator : ::testing::Test {
 	GrowingGlobalPoolAllocator<std::uint64_t, 8> allocator{10};
 };
@@ -184,6 +242,154 @@ TEST_F(LargeIntAllocator, RandomDeletes_ReturnsCorrectly)
 	}
 }
 
+TEST_F(LargeIntAllocator, Allocate_PrefersLowestFreeBucket)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	// Free from the top down so the most recently freed is in the highest bucket
+	auto *const lowest(ptrs[3 * 8 + 5].get());
+	ptrs[3 * 8 + 5].reset();
+	ptrs[20 * 8 + 1].reset();
+	ptrs[24 * 8 + 7].reset();
+
+	auto ptr(allocator.Allocate());
+	ASSERT_EQ(lowest, ptr.get());
+}
+
+TEST_F(LargeIntAllocator, AllocateN_ReturnsCorrectValues)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(150, std::back_inserter(ptrs), 42), 150);
+	ASSERT_EQ(ptrs.size(), 150);
+	ASSERT_EQ(allocator.Size(), 150);
+
+	std::unordered_set<const std::uint64_t *> unique;
+	for (const auto &ptr : ptrs) {
+		ASSERT_EQ(*ptr, 42);
+		unique.insert(ptr.get());
+	}
+	ASSERT_EQ(unique.size(), 150);
+}
+
+TEST_F(LargeIntAllocator, AllocateN_WhenFull_ReturnsNumberAllocated)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(150, std::back_inserter(ptrs)), 150);
+	ASSERT_EQ(allocator.AllocateN(100, std::back_inserter(ptrs)), 50);
+	ASSERT_EQ(ptrs.size(), 200);
+	ASSERT_EQ(allocator.AllocateN(1, std::back_inserter(ptrs)), 0);
+}
+
+TEST_F(LargeIntAllocator, AllocateN_ReusesFreedElementsFromLowestBucketFirst)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 100; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	const std::unordered_set<const std::uint64_t *> lowest{ptrs[10].get(), ptrs[11].get()};
+	const auto *const middle(ptrs[50].get());
+	const auto *const highest(ptrs[90].get());
+	for (const std::size_t i : {90, 50, 10, 11}) { ptrs[i].reset(); }
+
+	std::vector<Allocator::PtrType> batch;
+	ASSERT_EQ(allocator.AllocateN(6, std::back_inserter(batch), 7), 6);
+	ASSERT_EQ(lowest.count(batch[0].get()), 1);
+	ASSERT_EQ(lowest.count(batch[1].get()), 1);
+	ASSERT_EQ(middle, batch[2].get());
+	ASSERT_EQ(highest, batch[3].get());
+	for (const auto &ptr : batch) { ASSERT_EQ(*ptr, 7); }
+	for (std::size_t i(0); i < 100; ++i) {
+		if (nullptr != ptrs[i]) { ASSERT_EQ(*ptrs[i], i); }
+	}
+	ASSERT_EQ(allocator.Size(), 102);
+}
+
+TEST_F(LargeIntAllocator, FreeN_FreesEverythingAndNullsHandles)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(allocator.Capacity(), std::back_inserter(ptrs)), 200);
+	ptrs[3].reset();
+	ptrs[150].reset();
+
+	// Mix up the order so runs are broken across buckets
+	std::mt19937 gen(100);
+	std::shuffle(ptrs.begin() + 100, ptrs.end(), gen);
+
+	allocator.FreeN(std::span(ptrs).subspan(0, 120));
+	ASSERT_EQ(allocator.Size(), 79);
+	for (std::size_t i(0); i < 120; ++i) { ASSERT_EQ(nullptr, ptrs[i]); }
+
+	allocator.FreeN(ptrs);
+	ASSERT_EQ(allocator.Size(), 0);
+
+	// And everything can be allocated again
+	ASSERT_EQ(allocator.AllocateN(allocator.Capacity(), ptrs.begin(), 3), 200);
+	for (const auto &ptr : ptrs) { ASSERT_EQ(*ptr, 3); }
+}
+
+// Throws from the constructor once constructionsLeft runs out
+std::size_t constructionsLeft(0);
+
+struct ThrowingCtor {
+	explicit ThrowingCtor(std::uint64_t value) : value_(value)
+	{
+		if (constructionsLeft-- == 0) { throw std::runtime_error("constructor threw"); }
+	}
+
+	std::uint64_t value_;
+};
+
+template<typename Allocator>
+struct AllocateNThrowingAllocator : ::testing::Test {
+	Allocator allocator{200};
+
+	// Everything not yet handed out can still be allocated, exactly once
+	auto ExpectFullyAllocatable(std::vector<typename Allocator::PtrType> &ptrs) -> void
+	{
+		constructionsLeft = allocator.Capacity();
+		const std::size_t live(allocator.Size());
+		ASSERT_EQ(allocator.AllocateN(allocator.Capacity(), std::back_inserter(ptrs), 1),
+				  allocator.Capacity() - live);
+		std::unordered_set<const ThrowingCtor *> unique;
+		for (const auto &ptr : ptrs) { unique.insert(ptr.get()); }
+		ASSERT_EQ(unique.size(), allocator.Capacity());
+	}
+};
+
+using ThrowingAllocators =
+		::testing::Types<GrowingGlobalPoolAllocator<ThrowingCtor, 8>,
+						 GrowingGlobalPoolAllocator<ThrowingCtor, 8, AnyBucketEviction>>;
+TYPED_TEST_SUITE(AllocateNThrowingAllocator, ThrowingAllocators);
+
+TYPED_TEST(AllocateNThrowingAllocator, ThrowFromFreeList_KeepsTheListsIntact)
+{
+	std::vector<typename TypeParam::PtrType> ptrs;
+	constructionsLeft = 20;
+	ASSERT_EQ(this->allocator.AllocateN(20, std::back_inserter(ptrs), 0), 20);
+	this->allocator.FreeN(std::span(ptrs).subspan(0, 10));
+	ptrs.erase(ptrs.begin(), ptrs.begin() + 10);
+
+	constructionsLeft = 4;
+	ASSERT_THROW(this->allocator.AllocateN(10, std::back_inserter(ptrs), 0), std::runtime_error);
+	ASSERT_EQ(ptrs.size(), 14);
+	ASSERT_EQ(this->allocator.Size(), 14);
+
+	// Freeing what we were given mustn't put anything on the free lists twice
+	ptrs.erase(ptrs.begin() + 10, ptrs.end());
+	this->ExpectFullyAllocatable(ptrs);
+}
+
+TYPED_TEST(AllocateNThrowingAllocator, ThrowFromBump_CountsOnlyWhatWasConstructed)
+{
+	std::vector<typename TypeParam::PtrType> ptrs;
+	constructionsLeft = 4;
+	ASSERT_THROW(this->allocator.AllocateN(10, std::back_inserter(ptrs), 0), std::runtime_error);
+	ASSERT_EQ(ptrs.size(), 4);
+	ASSERT_EQ(this->allocator.Size(), 4);
+
+	this->ExpectFullyAllocatable(ptrs);
+}
+
 std::size_t ctorsCalled(0);
 std::size_t dtorsCalled(0);
 
@@ -309,6 +515,1140 @@ TEST_F(NonDefaultConstructableFixture, TypeIsMovable)
 	ASSERT_EQ(allocator.Size(), 0);
 }
 
+struct Keyed {
+	explicit Keyed(std::size_t key) : key_(key) {}
+	Keyed(Keyed &&rhs) noexcept : key_(std::exchange(rhs.key_, 0)) {}
+
+	std::size_t key_;
+};
+
+template<typename Storage>
+struct CompactingAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<Keyed, 8, Storage>;
+	Allocator allocator{64};
+	std::unordered_map<std::size_t, typename Allocator::PtrType> owners;
+
+	auto Relocate()
+	{
+		return [this](Keyed &moved, typename Allocator::PtrType &&newHandle) {
+			owners.at(moved.key_) = std::move(newHandle);
+		};
+	}
+};
+
+using CompactingStorages = ::testing::Types<HeapBuckets, ReservedAddressSpace>;
+TYPED_TEST_SUITE(CompactingAllocator, CompactingStorages);
+
+TYPED_TEST(CompactingAllocator, Compact_MovesSparseTopBucketsIntoHoles)
+{
+	for (std::size_t key(1); key <= 64; ++key) {
+		this->owners.emplace(key, this->allocator.Allocate(key));
+	}
+	const auto *const first(this->owners.at(1).get());
+
+	// Leave one long lived element in each high bucket and plenty of holes in the first two
+	for (std::size_t key(1); key <= 64; ++key) {
+		if ((key > 2 && key <= 16) || (key > 16 && key % 8 != 0)) { this->owners.erase(key); }
+	}
+	ASSERT_EQ(this->allocator.Size(), 8);
+
+	ASSERT_EQ(this->allocator.Compact(100, this->Relocate()), 6);
+	ASSERT_EQ(this->allocator.Size(), 8);
+
+	for (const auto &[key, ptr] : this->owners) {
+		ASSERT_EQ(ptr->key_, key);
+		if constexpr (std::is_same_v<TypeParam, ReservedAddressSpace>) {
+			// Everything now lives in the bottom two buckets
+			ASSERT_LT(ptr.get() - first, 16);
+		}
+	}
+
+	// The top buckets really were freed, so we can fill the pool again
+	std::vector<typename TestFixture::Allocator::PtrType> ptrs;
+	ASSERT_EQ(this->allocator.AllocateN(56, std::back_inserter(ptrs), 0), 56);
+}
+
+TYPED_TEST(CompactingAllocator, Compact_StopsAfterMaxMoves)
+{
+	for (std::size_t key(1); key <= 32; ++key) {
+		this->owners.emplace(key, this->allocator.Allocate(key));
+	}
+	for (std::size_t key(1); key <= 24; ++key) { this->owners.erase(key); }
+
+	ASSERT_EQ(this->allocator.Compact(3, this->Relocate()), 3);
+	ASSERT_EQ(this->allocator.Compact(3, this->Relocate()), 3);
+	ASSERT_EQ(this->allocator.Compact(3, this->Relocate()), 2);
+	ASSERT_EQ(this->allocator.Compact(3, this->Relocate()), 0);
+
+	ASSERT_EQ(this->allocator.Size(), 8);
+	for (const auto &[key, ptr] : this->owners) { ASSERT_EQ(ptr->key_, key); }
+}
+
+TYPED_TEST(CompactingAllocator, Compact_WhenTopBucketDoesNotFit_DoesNothing)
+{
+	for (std::size_t key(1); key <= 16; ++key) {
+		this->owners.emplace(key, this->allocator.Allocate(key));
+	}
+	for (std::size_t key(1); key <= 2; ++key) { this->owners.erase(key); }
+
+	ASSERT_EQ(this->allocator.Compact(100, this->Relocate()), 0);
+	for (const auto &[key, ptr] : this->owners) { ASSERT_EQ(ptr->key_, key); }
+}
+
+struct ThreadCachedAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, ThreadCached<4>>;
+	Allocator allocator{200};
+};
+
+TEST_F(ThreadCachedAllocator, SizeReturnsCorrectSize)
+{
+	ASSERT_EQ(allocator.Size(), 0);
+	{
+		auto a(allocator.Allocate(1));
+		auto b(allocator.Allocate(2));
+		ASSERT_EQ(allocator.Size(), 2);
+		{
+			auto c(allocator.Allocate(3));
+			ASSERT_EQ(allocator.Size(), 3);
+		}
+		ASSERT_EQ(allocator.Size(), 2);
+		ASSERT_EQ(*a, 1);
+		ASSERT_EQ(*b, 2);
+	}
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+TEST_F(ThreadCachedAllocator, CreatingMoreThanMaxSize_ReturnsNullptr)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+		ptrs.push_back(allocator.Allocate(i));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+
+	ASSERT_EQ(nullptr, allocator.Allocate());
+
+	ptrs.pop_back();
+	ASSERT_NE(nullptr, allocator.Allocate());
+}
+
+TEST_F(ThreadCachedAllocator, FreeingOnAnotherThread_ReturnsMemoryToPool)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) { ptrs.push_back(allocator.Allocate(i)); }
+	ASSERT_EQ(allocator.Size(), allocator.Capacity());
+
+	std::thread([&]() { ptrs.clear(); }).join();
+	ASSERT_EQ(allocator.Size(), 0);
+
+	// The freeing thread has exited so everything it cached is available to us again
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+		ptrs.push_back(allocator.Allocate(i));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+}
+
+TEST_F(ThreadCachedAllocator, AllocateNAndFreeN_ReturnsCorrectValues)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(allocator.Capacity() + 10, std::back_inserter(ptrs), 5), 200);
+	for (const auto &ptr : ptrs) { ASSERT_EQ(*ptr, 5); }
+	ASSERT_EQ(allocator.Size(), 200);
+
+	allocator.FreeN(ptrs);
+	for (const auto &ptr : ptrs) { ASSERT_EQ(nullptr, ptr); }
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+TEST_F(ThreadCachedAllocator, ManyThreads_ReturnsCorrectValues)
+{
+	constexpr std::size_t numThreads(4);
+	constexpr std::size_t perThread(40);
+
+	std::vector<std::thread> threads;
+	for (std::size_t t(0); t < numThreads; ++t) {
+		threads.emplace_back([&, t]() {
+			std::mt19937 gen(t);
+			std::uniform_int_distribution<std::size_t> dis(0, perThread - 1);
+
+			std::vector<Allocator::PtrType> ptrs;
+			for (std::size_t i(0); i < perThread; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+			for (std::size_t run(0); run < 10'000; ++run) {
+				const auto location(dis(gen));
+				ASSERT_EQ(*ptrs[location], location);
+				ptrs[location] = allocator.Allocate(location);
+				ASSERT_NE(nullptr, ptrs[location]);
+			}
+		});
+	}
+	for (auto &thread : threads) { thread.join(); }
+
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+struct LockFreeAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, LockFree>;
+	Allocator allocator{200};
+};
+
+TEST_F(LockFreeAllocator, CreatingMoreThanMaxSize_ReturnsNullptr)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+		ptrs.push_back(allocator.Allocate(i));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+	ASSERT_EQ(allocator.Size(), allocator.Capacity());
+
+	ASSERT_EQ(nullptr, allocator.Allocate());
+
+	ptrs.pop_back();
+	ASSERT_EQ(allocator.Size(), allocator.Capacity() - 1);
+	ASSERT_NE(nullptr, allocator.Allocate());
+}
+
+TEST_F(LockFreeAllocator, FreeReusesLowestBucket)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 32; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	auto *lowest(ptrs[3].get());
+	ptrs[3].reset();
+	ptrs[30].reset();
+
+	ASSERT_EQ(lowest, allocator.Allocate().get());
+}
+
+TEST_F(LockFreeAllocator, EmptiedListsStaleBit_StillReusesOtherLists)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 32; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+	ptrs[3].reset();
+	ptrs[30].reset();
+
+	// Empties the first bucket's list but leaves its bit set, the next pop must skip it and take
+	// the element in the last bucket rather than grow the pool
+	ptrs[3] = allocator.Allocate();
+	ptrs[30] = allocator.Allocate();
+	ASSERT_EQ(ptrs[30].Index(), 30);
+	ASSERT_EQ(allocator.Size(), 32);
+	ASSERT_EQ(allocator.Allocate().Index(), 32);
+}
+
+TEST_F(LockFreeAllocator, StressProducerConsumer_ReturnsCorrectValues)
+{
+	// Producers allocate, consumers check and free, so nearly every free happens on a different
+	// thread to the allocation. The queue is locked, the pool isn't.
+	constexpr std::size_t numPairs(2);
+	constexpr std::size_t perProducer(20'000);
+
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::deque<Allocator::PtrType> queue;
+	std::size_t producersFinished(0);
+
+	std::vector<std::thread> threads;
+	for (std::size_t p(0); p < numPairs; ++p) {
+		threads.emplace_back([&, p]() {
+			for (std::size_t i(0); i < perProducer; ++i) {
+				auto ptr(allocator.Allocate(p * perProducer + i));
+				while (ptr == nullptr) {
+					// Consumers are behind, give them a chance
+					std::this_thread::yield();
+					ptr = allocator.Allocate(p * perProducer + i);
+				}
+				std::scoped_lock lock(mutex);
+				queue.push_back(std::move(ptr));
+				notEmpty.notify_one();
+			}
+			std::scoped_lock lock(mutex);
+			++producersFinished;
+			notEmpty.notify_all();
+		});
+		threads.emplace_back([&]() {
+			while (true) {
+				Allocator::PtrType ptr(Allocator::PtrType::CreateNullPtr());
+				{
+					std::unique_lock lock(mutex);
+					notEmpty.wait(lock,
+								  [&]() { return !queue.empty() || producersFinished == numPairs; });
+					if (queue.empty()) { return; }
+					ptr = std::move(queue.front());
+					queue.pop_front();
+				}
+				ASSERT_LT(*ptr, numPairs * perProducer);
+			}
+		});
+	}
+
+	// And some threads just churning on their own at the same time
+	for (std::size_t t(0); t < 2; ++t) {
+		threads.emplace_back([&, t]() {
+			std::mt19937 gen(t);
+			std::uniform_int_distribution<std::size_t> dis(0, 9);
+			std::vector<Allocator::PtrType> ptrs;
+			for (std::size_t i(0); i < 10; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+			for (std::size_t run(0); run < 20'000; ++run) {
+				const auto location(dis(gen));
+				if (nullptr != ptrs[location]) { ASSERT_EQ(*ptrs[location], location); }
+				ptrs[location] = allocator.Allocate(location);
+			}
+		});
+	}
+
+	for (auto &thread : threads) { thread.join(); }
+
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+struct FirstShard;
+struct SecondShard;
+
+TEST(TaggedAllocator, PoolsWithDifferentTagsAreIndependent)
+{
+	using First = GrowingGlobalPoolAllocator<std::uint64_t, 8, PoolTag<FirstShard>>;
+	using Second = GrowingGlobalPoolAllocator<std::uint64_t, 8, PoolTag<SecondShard>>;
+	static_assert(sizeof(First::PtrType) == 4);
+	static_assert(!std::is_same_v<First::PtrType, Second::PtrType>);
+
+	First first{16};
+	Second second{8};
+
+	std::vector<First::PtrType> firstPtrs;
+	std::vector<Second::PtrType> secondPtrs;
+	for (std::size_t i(0); i < 8; ++i) {
+		firstPtrs.push_back(first.Allocate(i));
+		secondPtrs.push_back(second.Allocate(i + 100));
+	}
+
+	ASSERT_EQ(first.Size(), 8);
+	ASSERT_EQ(second.Size(), 8);
+	ASSERT_EQ(nullptr, second.Allocate());
+	ASSERT_NE(nullptr, first.Allocate());
+
+	secondPtrs.clear();
+	ASSERT_EQ(first.Size(), 8);
+	ASSERT_EQ(second.Size(), 0);
+	for (std::size_t i(0); i < 8; ++i) { ASSERT_EQ(*firstPtrs[i], i); }
+}
+
+template<std::size_t... shards>
+void RunOnePoolPerShard(std::index_sequence<shards...>)
+{
+	auto runShard([]<std::size_t shard>(std::integral_constant<std::size_t, shard>) {
+		using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, PoolId<shard>>;
+		Allocator allocator{64};
+		std::vector<typename Allocator::PtrType> ptrs;
+		for (std::size_t loop(0); loop < 100; ++loop) {
+			for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+				ptrs.push_back(allocator.Allocate(shard * 1000 + i));
+			}
+			for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+				ASSERT_EQ(*ptrs[i], shard * 1000 + i);
+			}
+			ptrs.clear();
+		}
+	});
+
+	// Each pool is single threaded but only touched by its own thread
+	std::vector<std::thread> threads;
+	(threads.emplace_back(runShard, std::integral_constant<std::size_t, shards>{}), ...);
+	for (auto &thread : threads) { thread.join(); }
+}
+
+TEST(TaggedAllocator, OnePoolPerShard_ReturnsCorrectValues)
+{
+	RunOnePoolPerShard(std::make_index_sequence<4>{});
+}
+
+struct ReservedIntAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, ReservedAddressSpace>;
+	Allocator allocator{200};
+};
+
+TEST_F(ReservedIntAllocator, RandomDeletes_ReturnsCorrectly)
+{
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<> dis(0, 1);
+
+	for (std::size_t runs(0); runs < 10; ++runs) {
+		std::unordered_map<std::size_t, Allocator::PtrType> map;
+		for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+			Allocator::PtrType ptr(allocator.Allocate());
+			ASSERT_NE(nullptr, ptr);
+			*ptr = i;
+			map.insert(std::make_pair(i, std::move(ptr)));
+		}
+
+		for (auto iter(map.begin()); iter != map.end();) {
+			if (dis(gen) == 0) {
+				iter = map.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+
+		for (auto &[value, ptr] : map) { ASSERT_EQ(value, *ptr); }
+	}
+}
+
+TEST_F(ReservedIntAllocator, ElementsAreContiguousAcrossBuckets)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 3 * 8; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	for (std::size_t i(1); i < ptrs.size(); ++i) {
+		ASSERT_EQ(ptrs[i - 1].get() + 1, ptrs[i].get());
+	}
+}
+
+TEST_F(ReservedIntAllocator, EvictedBucketsCanBeReused)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t loop(0); loop < 3; ++loop) {
+		for (std::size_t i(0); i < allocator.Capacity(); ++i) {
+			ptrs.push_back(allocator.Allocate(i));
+		}
+		for (std::size_t i(0); i < allocator.Capacity(); ++i) { ASSERT_EQ(*ptrs[i], i); }
+		while (!ptrs.empty()) { ptrs.pop_back(); }
+		ASSERT_EQ(allocator.Size(), 0);
+	}
+}
+
+struct ReservedLockFreeAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, LockFree, ReservedAddressSpace>;
+	Allocator allocator{200};
+};
+
+TEST_F(ReservedLockFreeAllocator, ManyThreads_ReturnsCorrectValues)
+{
+	std::vector<std::thread> threads;
+	for (std::size_t t(0); t < 4; ++t) {
+		threads.emplace_back([&, t]() {
+			for (std::size_t loop(0); loop < 100; ++loop) {
+				std::vector<Allocator::PtrType> ptrs;
+				for (std::size_t i(0); i < 50; ++i) {
+					ptrs.push_back(allocator.Allocate(t * 1000 + i));
+				}
+				for (std::size_t i(0); i < 50; ++i) { ASSERT_EQ(*ptrs[i], t * 1000 + i); }
+			}
+		});
+	}
+
+	for (auto &thread : threads) { thread.join(); }
+
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+template<typename Storage>
+struct HugePageAllocator : ::testing::Test {
+	// 3/4 of a huge page per bucket so the tail of each one is padding
+	using Allocator = GrowingGlobalPoolAllocator<std::array<char, 96>, 16'384, Storage>;
+	Allocator allocator{16'384 * 4};
+};
+
+using HugePageStorages = ::testing::Types<TransparentHugePages, ExplicitHugePages>;
+TYPED_TEST_SUITE(HugePageAllocator, HugePageStorages);
+
+TYPED_TEST(HugePageAllocator, BucketsStartOnHugePageBoundaries)
+{
+	constexpr std::size_t hugePageSize(std::size_t{2} * 1024 * 1024);
+
+	std::vector<typename TestFixture::Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < this->allocator.Capacity(); ++i) {
+		ptrs.push_back(this->allocator.Allocate());
+		ASSERT_NE(nullptr, ptrs.back());
+		if (i % 16'384 == 0) {
+			ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptrs.back().get()) % hugePageSize, 0);
+		} else {
+			ASSERT_EQ(ptrs[i - 1].get() + 1, ptrs[i].get());
+		}
+	}
+}
+
+TYPED_TEST(HugePageAllocator, EvictedBucketsCanBeReused)
+{
+	std::vector<typename TestFixture::Allocator::PtrType> ptrs;
+	for (std::size_t loop(0); loop < 3; ++loop) {
+		for (std::size_t i(0); i < this->allocator.Capacity(); ++i) {
+			ptrs.push_back(this->allocator.Allocate());
+			memcpy(ptrs.back()->data(), &i, sizeof(i));
+		}
+		for (std::size_t i(0); i < this->allocator.Capacity(); ++i) {
+			std::size_t value(0);
+			memcpy(&value, ptrs[i]->data(), sizeof(value));
+			ASSERT_EQ(value, i);
+		}
+		while (!ptrs.empty()) { ptrs.pop_back(); }
+		ASSERT_EQ(this->allocator.Size(), 0);
+	}
+}
+
+// Resident set size in bytes
+std::size_t ResidentMem()
+{
+	std::ifstream statm("/proc/self/statm");
+	std::size_t size(0);
+	std::size_t resident(0);
+	statm >> size >> resident;
+	return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Sanitizers keep their shadow memory resident, which swamps the pages a pool gives back, so the
+// tests that measure the resident set size are skipped under them
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr bool RESIDENT_MEM_IS_MEANINGFUL(false);
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) ||                      \
+		__has_feature(memory_sanitizer)
+constexpr bool RESIDENT_MEM_IS_MEANINGFUL(false);
+#else
+constexpr bool RESIDENT_MEM_IS_MEANINGFUL(true);
+#endif
+#else
+constexpr bool RESIDENT_MEM_IS_MEANINGFUL(true);
+#endif
+
+TEST(ReservedAddressSpaceMemTest, EvictingBucketsReturnsMemoryToTheOs)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	// 64KB buckets so each one is whole pages
+	using Allocator =
+			GrowingGlobalPoolAllocator<std::array<char, 4'096>, 16, ReservedAddressSpace>;
+	constexpr std::size_t numOfElements(16 * 256);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+	ptrs.reserve(numOfElements);
+
+	const auto startingMem(ResidentMem());
+	for (std::size_t i(0); i < numOfElements; ++i) {
+		ptrs.push_back(allocator.Allocate());
+		ptrs.back()->fill(static_cast<char>(i));
+	}
+	const auto allocatedMem(ResidentMem());
+	ASSERT_GE(allocatedMem - startingMem, numOfElements * 4'096 / 2);
+
+	while (!ptrs.empty()) { ptrs.pop_back(); }
+	const auto freedMem(ResidentMem());
+
+	// Only the bottom couple of buckets are kept around
+	ASSERT_LT(freedMem - std::min(freedMem, startingMem), (allocatedMem - startingMem) / 4);
+}
+
+TEST(DeferredMaintenanceMemTest, EvictedBucketsAreOnlyFreedByMaintain)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	using Allocator = GrowingGlobalPoolAllocator<std::array<char, 4'096>, 16, ReservedAddressSpace,
+												 DeferredMaintenance>;
+	constexpr std::size_t numOfElements(16 * 256);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+	ptrs.reserve(numOfElements);
+
+	const auto startingMem(ResidentMem());
+	for (std::size_t i(0); i < numOfElements; ++i) {
+		ptrs.push_back(allocator.Allocate());
+		ptrs.back()->fill(static_cast<char>(i));
+	}
+	const auto allocatedMem(ResidentMem());
+
+	while (!ptrs.empty()) { ptrs.pop_back(); }
+	ASSERT_GE(ResidentMem() - startingMem, (allocatedMem - startingMem) * 3 / 4);
+
+	allocator.Maintain();
+	const auto freedMem(ResidentMem());
+	ASSERT_LT(freedMem - std::min(freedMem, startingMem), (allocatedMem - startingMem) / 4);
+
+	// And buckets evicted then grown back into before Maintain are left alone
+	for (std::size_t loop(0); loop < 3; ++loop) {
+		for (std::size_t i(0); i < numOfElements; ++i) { ptrs.push_back(allocator.Allocate()); }
+		while (!ptrs.empty()) { ptrs.pop_back(); }
+		for (std::size_t i(0); i < numOfElements / 2; ++i) {
+			ptrs.push_back(allocator.Allocate());
+			ptrs.back()->fill(static_cast<char>(i));
+		}
+		allocator.Maintain();
+		for (std::size_t i(0); i < ptrs.size(); ++i) {
+			ASSERT_EQ(ptrs[i]->back(), static_cast<char>(i));
+		}
+		ptrs.clear();
+	}
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+TEST(DeferredMaintenanceMemTest, MaintainFaultsInTheNextBucket)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	// 1MB buckets
+	using Allocator = GrowingGlobalPoolAllocator<std::array<char, 4'096>, 256, ReservedAddressSpace,
+												 DeferredMaintenance, PoolId<1>>;
+	Allocator allocator{256 * 4};
+
+	const auto startingMem(ResidentMem());
+	allocator.Maintain();
+	ASSERT_GE(ResidentMem() - startingMem, 256 * 4'096 * 3 / 4);
+
+	// It's already there so growing into it doesn't need to fault anything in
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(256, std::back_inserter(ptrs)), 256);
+	allocator.Maintain();
+	ASSERT_GE(ResidentMem() - startingMem, 2 * 256 * 4'096 * 3 / 4);
+}
+
+TEST(PoolMaintainerTest, ThreadCachedPoolWithBackgroundMaintenance_ReturnsCorrectValues)
+{
+	using Allocator =
+			GrowingGlobalPoolAllocator<std::uint64_t, 8, ThreadCached<4>, DeferredMaintenance>;
+	Allocator allocator{400};
+	{
+		PoolMaintainer maintainer{allocator, std::chrono::microseconds(50)};
+
+		std::vector<std::thread> threads;
+		for (std::size_t t(0); t < 4; ++t) {
+			threads.emplace_back([&, t]() {
+				for (std::size_t loop(0); loop < 200; ++loop) {
+					std::vector<Allocator::PtrType> ptrs;
+					for (std::size_t i(0); i < 80; ++i) {
+						ptrs.push_back(allocator.Allocate(t * 1000 + i));
+						ASSERT_NE(nullptr, ptrs.back());
+					}
+					for (std::size_t i(0); i < 80; ++i) { ASSERT_EQ(*ptrs[i], t * 1000 + i); }
+				}
+			});
+		}
+		for (auto &thread : threads) { thread.join(); }
+	}
+
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+struct StatsAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, CollectStats>;
+	Allocator allocator{40};
+};
+
+TEST_F(StatsAllocator, CountsWhatThePoolDid)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(40, std::back_inserter(ptrs)), 40);
+	ASSERT_EQ(nullptr, allocator.Allocate());
+
+	auto stats(allocator.GetStats());
+	ASSERT_EQ(stats.allocations, 40);
+	ASSERT_EQ(stats.failedAllocations, 1);
+	ASSERT_EQ(stats.bumpAllocations, 40);
+	ASSERT_EQ(stats.freeListPops, 0);
+	ASSERT_EQ(stats.bucketsCreated, 5);
+	ASSERT_EQ(stats.size, 40);
+	ASSERT_EQ(stats.capacity, 40);
+	ASSERT_EQ(stats.lowestFreeBucket, HierarchicalBitmap<>::NONE);
+	ASSERT_EQ(stats.bucketOccupancy, std::vector<std::size_t>(5, 8));
+
+	// Emptying the top two buckets evicts one of them
+	for (std::size_t i(0); i < 16; ++i) { ptrs.pop_back(); }
+	ptrs.push_back(allocator.Allocate());
+
+	stats = allocator.GetStats();
+	ASSERT_EQ(stats.allocations, 41);
+	ASSERT_EQ(stats.frees, 16);
+	ASSERT_EQ(stats.freeListPops, 1);
+	ASSERT_EQ(stats.bucketsEvicted, 1);
+	ASSERT_EQ(stats.size, 25);
+	ASSERT_EQ(stats.lowestFreeBucket, 3);
+	ASSERT_EQ(stats.bucketOccupancy, (std::vector<std::size_t>{8, 8, 8, 1}));
+}
+
+TEST(PoolStatsTest, NewPool_StartsCountingAgain)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, CollectStats, PoolId<2>>;
+	{
+		Allocator allocator{40};
+		ASSERT_NE(nullptr, allocator.Allocate());
+		ASSERT_EQ(allocator.GetStats().allocations, 1);
+	}
+
+	Allocator allocator{40};
+	ASSERT_EQ(allocator.GetStats().allocations, 0);
+	ASSERT_EQ(allocator.GetStats().frees, 0);
+}
+
+TEST(ThreadCachedStats, CountsOfExitedThreadsAreKept)
+{
+	using Allocator =
+			GrowingGlobalPoolAllocator<std::uint64_t, 8, ThreadCached<4>, CollectStats>;
+	Allocator allocator{400};
+
+	std::vector<std::thread> threads;
+	for (std::size_t t(0); t < 4; ++t) {
+		threads.emplace_back([&]() {
+			for (std::size_t loop(0); loop < 10; ++loop) {
+				std::vector<Allocator::PtrType> ptrs;
+				for (std::size_t i(0); i < 50; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+			}
+		});
+	}
+	for (auto &thread : threads) { thread.join(); }
+
+	const auto stats(allocator.GetStats());
+	ASSERT_EQ(stats.allocations, 4 * 10 * 50);
+	ASSERT_EQ(stats.frees, 4 * 10 * 50);
+	ASSERT_EQ(stats.failedAllocations, 0);
+	ASSERT_EQ(stats.size, 0);
+	ASSERT_LE(stats.bumpAllocations, 400);
+}
+
+template<typename Eviction>
+struct EvictingAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, Eviction>;
+	Allocator allocator{200};
+};
+
+using EvictionPolicies = ::testing::Types<HighestBucketEviction, WatermarkEviction<2, 1>,
+										  IdleEviction<0>, AnyBucketEviction>;
+TYPED_TEST_SUITE(EvictingAllocator, EvictionPolicies);
+
+TYPED_TEST(EvictingAllocator, RandomFreesAndRefills_ReturnsCorrectValues)
+{
+	using Allocator = typename TestFixture::Allocator;
+	auto &allocator(this->allocator);
+
+	// Free most of them so plenty of buckets in the middle end up completely free
+	std::vector<typename Allocator::PtrType> ptrs;
+	ASSERT_NO_FATAL_FAILURE(RandomFreesAndRefills(allocator, ptrs, 10));
+
+	const std::size_t space(allocator.Capacity() - allocator.Size());
+	std::vector<typename Allocator::PtrType> more;
+	ASSERT_EQ(allocator.AllocateN(allocator.Capacity(), std::back_inserter(more), 7), space);
+	for (const auto &ptr : more) { ASSERT_EQ(*ptr, 7); }
+	allocator.FreeN(more);
+	ptrs.clear();
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+struct alignas(64) OverAligned {
+	std::uint64_t value_;
+};
+
+template<typename Storage>
+struct OverAlignedAllocator : ::testing::Test {
+	using Allocator = GrowingGlobalPoolAllocator<OverAligned, 8, Storage>;
+	Allocator allocator{100};
+};
+
+using LayoutStorages = ::testing::Types<HeapBuckets, ReservedAddressSpace>;
+TYPED_TEST_SUITE(OverAlignedAllocator, LayoutStorages);
+
+TYPED_TEST(OverAlignedAllocator, ElementsAreAligned)
+{
+	std::vector<typename TestFixture::Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 100; ++i) {
+		ptrs.push_back(this->allocator.Allocate(OverAligned{i}));
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptrs.back().get()) % 64, 0);
+	}
+	for (std::size_t i(0); i < 100; ++i) { ASSERT_EQ(ptrs[i]->value_, i); }
+}
+
+TEST(CacheLinePaddedAllocator, ElementsHaveALineEach)
+{
+	GrowingGlobalPoolAllocator<std::uint64_t, 8, CacheLinePadded, ReservedAddressSpace> allocator{
+			100};
+	auto first(allocator.Allocate(1));
+	auto second(allocator.Allocate(2));
+
+	const auto firstAddress(reinterpret_cast<std::uintptr_t>(first.get()));
+	ASSERT_EQ(firstAddress % CacheLinePadded::CACHE_LINE_SIZE, 0);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(second.get()) - firstAddress,
+			  CacheLinePadded::CACHE_LINE_SIZE);
+	ASSERT_EQ(*first, 1);
+	ASSERT_EQ(*second, 2);
+}
+
+template<typename Allocator>
+struct PackedAllocator : ::testing::Test {
+	Allocator allocator{200};
+};
+
+using PackedAllocators =
+		::testing::Types<GrowingGlobalPoolAllocator<std::uint8_t, 8, PackedLayout>,
+						 GrowingGlobalPoolAllocator<std::uint16_t, 8, PackedLayout,
+													ReservedAddressSpace>,
+						 GrowingGlobalPoolAllocator<std::uint8_t, 8, PackedLayout, AnyBucketEviction,
+													PoolId<1>>,
+						 GrowingGlobalPoolAllocator<std::uint8_t, 8, PackedLayout, LockFree,
+													PoolId<2>>>;
+TYPED_TEST_SUITE(PackedAllocator, PackedAllocators);
+
+TYPED_TEST(PackedAllocator, RandomFreesAndRefills_ReturnsCorrectValues)
+{
+	std::vector<typename TypeParam::PtrType> ptrs;
+	ASSERT_NO_FATAL_FAILURE(RandomFreesAndRefills(this->allocator, ptrs, 4));
+	ptrs.clear();
+	ASSERT_EQ(this->allocator.Size(), 0);
+}
+
+TEST(PackedLayoutTest, ElementsAreSizeofTApart)
+{
+	GrowingGlobalPoolAllocator<std::uint8_t, 8, PackedLayout, ReservedAddressSpace> allocator{100};
+	std::vector<decltype(allocator)::PtrType> ptrs;
+	for (std::uint8_t i(0); i < 20; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+	for (std::size_t i(1); i < ptrs.size(); ++i) {
+		ASSERT_EQ(ptrs[i].get() - ptrs[i - 1].get(), 1);
+		ASSERT_EQ(*ptrs[i], i);
+	}
+}
+
+template<typename Allocator>
+struct HandleWidthAllocator : ::testing::Test {
+	Allocator allocator{200};
+};
+
+using HandleWidthAllocators = ::testing::Types<
+		GrowingGlobalPoolAllocator<std::uint16_t, 8, TwoByteHandles>,
+		GrowingGlobalPoolAllocator<std::uint16_t, 8, TwoByteHandles, ReservedAddressSpace,
+								   TrackLiveObjects>,
+		GrowingGlobalPoolAllocator<std::uint16_t, 8, TwoByteHandles, ThreadCached<4>>,
+		GrowingGlobalPoolAllocator<std::uint8_t, 8, TwoByteHandles, PackedLayout, RefCounted>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, EightByteHandles>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, EightByteHandles, AnyBucketEviction,
+								   PackedLayout>>;
+TYPED_TEST_SUITE(HandleWidthAllocator, HandleWidthAllocators);
+
+TYPED_TEST(HandleWidthAllocator, HandlesAreTheIndexTypesSize)
+{
+	using Allocator = TypeParam;
+	static_assert(sizeof(typename Allocator::PtrType) == sizeof(typename Allocator::IndexType));
+	static_assert(Allocator::MAX_ELEMENTS ==
+				  std::numeric_limits<typename Allocator::IndexType>::max());
+}
+
+TYPED_TEST(HandleWidthAllocator, RandomFreesAndRefills_ReturnsCorrectValues)
+{
+	auto &allocator(this->allocator);
+	std::vector<typename TypeParam::PtrType> ptrs;
+	ASSERT_NO_FATAL_FAILURE(RandomFreesAndRefills(allocator, ptrs, 4));
+
+	allocator.FreeN(ptrs);
+	ASSERT_EQ(allocator.Size(), 0);
+	ASSERT_EQ(allocator.AllocateN(ptrs.size(), ptrs.begin(), 1), ptrs.size());
+	ASSERT_EQ(allocator.Size(), ptrs.size());
+}
+
+TEST(HandleWidthTest, TwoByteHandles_IndexEveryElementButTheNullHandle)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint16_t, 4'096, TwoByteHandles>;
+	Allocator allocator{MaxElements<Allocator::MAX_ELEMENTS>{}};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < Allocator::MAX_ELEMENTS; ++i) {
+		ptrs.push_back(allocator.Allocate(static_cast<std::uint16_t>(i)));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+	ASSERT_EQ(nullptr, allocator.Allocate(0));
+	ASSERT_EQ(ptrs.back().Index(), Allocator::PtrType::MAX_PTR);
+	for (std::size_t i(0); i < ptrs.size(); ++i) { ASSERT_EQ(*ptrs[i], i); }
+}
+
+template<typename Allocator>
+struct LiveTrackingAllocator : ::testing::Test {
+	Allocator allocator{100};
+};
+
+using LiveTrackingAllocators = ::testing::Types<
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects, AnyBucketEviction>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects, LockFree>,
+		GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects, ThreadCached<4>>>;
+TYPED_TEST_SUITE(LiveTrackingAllocator, LiveTrackingAllocators);
+
+TYPED_TEST(LiveTrackingAllocator, ForEachLive_VisitsLiveElementsInOrder)
+{
+	using Allocator = TypeParam;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < 100; ++i) { ptrs.push_back(this->allocator.Allocate(i)); }
+	for (std::size_t i(0); i < ptrs.size(); i += 3) { ptrs[i].reset(); }
+
+	std::vector<std::uint64_t> values;
+	FourBytePtr previous(0);
+	Allocator::ForEachLive([&](std::uint64_t &value, FourBytePtr ptr) {
+		if (!values.empty()) { EXPECT_GT(ptr, previous); }
+		previous = ptr;
+		values.push_back(value);
+	});
+	std::sort(values.begin(), values.end());
+
+	std::vector<std::uint64_t> expected;
+	for (std::uint64_t i(0); i < 100; ++i) {
+		if (i % 3 != 0) { expected.push_back(i); }
+	}
+	ASSERT_EQ(values, expected);
+}
+
+TYPED_TEST(LiveTrackingAllocator, LiveObjects_MatchesForEachLive)
+{
+	using Allocator = TypeParam;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < 50; ++i) { ptrs.push_back(this->allocator.Allocate(i)); }
+	for (std::size_t i(0); i < ptrs.size(); i += 2) { ptrs[i].reset(); }
+
+	std::vector<FourBytePtr> visited;
+	Allocator::ForEachLive([&](std::uint64_t &, FourBytePtr ptr) { visited.push_back(ptr); });
+
+	std::vector<FourBytePtr> iterated;
+	const auto live(Allocator::LiveObjects());
+	for (auto iter(live.begin()); iter != live.end(); ++iter) {
+		ASSERT_TRUE(Allocator::IsLive(iter.Index()));
+		ASSERT_EQ(&*iter, Allocator::AddressOf(iter.Index()));
+		iterated.push_back(iter.Index());
+	}
+	ASSERT_EQ(visited, iterated);
+	ASSERT_EQ(iterated.size(), 25);
+	ASSERT_EQ(std::distance(live.begin(), live.end()), 25);
+}
+
+TYPED_TEST(LiveTrackingAllocator, EmptyPool_HasNothingLive)
+{
+	using Allocator = TypeParam;
+	std::size_t count(0);
+	Allocator::ForEachLive([&](std::uint64_t &) { ++count; });
+	ASSERT_EQ(count, 0);
+	ASSERT_TRUE(Allocator::LiveObjects().begin() == Allocator::LiveObjects().end());
+}
+
+TYPED_TEST(LiveTrackingAllocator, ForEachLiveParallel_VisitsEveryLiveElementOnce)
+{
+	using Allocator = TypeParam;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < 100; ++i) { ptrs.push_back(this->allocator.Allocate(i)); }
+	for (std::size_t i(0); i < ptrs.size(); i += 3) { ptrs[i].reset(); }
+
+	// Buckets of 8 share bitmap words, so threads must only take the bits of their own buckets
+	for (const std::size_t numThreads : {1, 3, 8, 64}) {
+		std::vector<std::atomic<std::size_t>> visits(ptrs.size());
+		Allocator::ForEachLiveParallel(numThreads, [&](std::uint64_t &value, FourBytePtr ptr) {
+			EXPECT_EQ(&value, Allocator::AddressOf(ptr));
+			visits[value].fetch_add(1);
+		});
+		for (std::size_t i(0); i < visits.size(); ++i) {
+			ASSERT_EQ(visits[i].load(), i % 3 == 0 ? 0 : 1) << numThreads << " threads";
+		}
+	}
+}
+
+TEST(LiveTrackingTest, ForEachLiveParallel_FreesInAThreadSafePool)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects, LockFree>;
+	Allocator allocator{1'000};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < 1'000; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	// Each handle is only reset by the thread that visits its element
+	std::atomic<std::size_t> visited(0);
+	Allocator::ForEachLiveParallel(4, [&](std::uint64_t &value) {
+		visited.fetch_add(1);
+		if (value % 2 == 1) { ptrs[value].reset(); }
+	});
+	ASSERT_EQ(visited.load(), 1'000);
+	ASSERT_EQ(allocator.Size(), 500);
+	for (FourBytePtr i(0); i < ptrs.size(); ++i) { ASSERT_EQ(Allocator::IsLive(i), i % 2 == 0); }
+}
+
+TEST(LiveTrackingTest, FreeingDuringTheWalk_VisitsEveryElementOnce)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects>;
+	Allocator allocator{100};
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::uint64_t i(0); i < 100; ++i) { ptrs.push_back(allocator.Allocate(i)); }
+
+	// Expire every odd element, which evicts buckets as we go
+	std::size_t visited(0);
+	Allocator::ForEachLive([&](std::uint64_t &value) {
+		++visited;
+		if (value % 2 == 1) { ptrs[value].reset(); }
+	});
+	ASSERT_EQ(visited, 100);
+	ASSERT_EQ(allocator.Size(), 50);
+
+	// And expire everything from the top down, including elements we haven't reached yet
+	visited = 0;
+	Allocator::ForEachLive([&](std::uint64_t &element) {
+		++visited;
+		// Copied as freeing the element overwrites it
+		const std::uint64_t value(element);
+		ptrs[value].reset();
+		ptrs[98 - value].reset();
+	});
+	ASSERT_EQ(visited, 25);
+	ASSERT_EQ(allocator.Size(), 0);
+}
+
+TEST(LiveTrackingTest, BulkCallsAndCompact_KeepTrack)
+{
+	using Allocator = GrowingGlobalPoolAllocator<std::uint64_t, 8, TrackLiveObjects>;
+	Allocator allocator{100};
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(40, std::back_inserter(ptrs), 0), 40);
+	for (std::size_t i(0); i < ptrs.size(); ++i) { *ptrs[i] = i; }
+	allocator.FreeN(std::span(ptrs).subspan(0, 20));
+	for (FourBytePtr i(0); i < ptrs.size(); ++i) { ASSERT_EQ(Allocator::IsLive(i), i >= 20); }
+
+	// Moves the top bucket's elements down into the holes, each value is where its handle lives
+	const auto moved(allocator.Compact(100, [&](std::uint64_t &value, Allocator::PtrType &&ptr) {
+		ptrs[value] = std::move(ptr);
+	}));
+	ASSERT_GT(moved, 0);
+
+	std::size_t live(0);
+	Allocator::ForEachLive([&](std::uint64_t &value, FourBytePtr ptr) {
+		EXPECT_EQ(ptrs[value].Index(), ptr);
+		EXPECT_LT(ptr, 32);
+		++live;
+	});
+	ASSERT_EQ(live, 20);
+}
+
+// 256KB buckets so we can see each one in the resident set size
+template<typename... Options>
+using PageSizedAllocator =
+		GrowingGlobalPoolAllocator<std::array<char, 4'096>, 64, ReservedAddressSpace, Options...>;
+constexpr std::size_t PAGE_SIZED_BUCKET_BYTES(64 * 4'096);
+
+TEST(EvictionMemTest, AnyBucketEviction_ReleasesFreeBucketsBelowTheTop)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	using Allocator = PageSizedAllocator<AnyBucketEviction>;
+	constexpr std::size_t numOfElements(64 * 32);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+
+	const auto startingMem(ResidentMem());
+	for (std::size_t i(0); i < numOfElements; ++i) {
+		ptrs.push_back(allocator.Allocate());
+		ptrs.back()->fill(static_cast<char>(i));
+	}
+	const auto allocatedMem(ResidentMem());
+
+	// The last element pins the top bucket, so only AnyBucketEviction can free the rest
+	for (std::size_t i(0); i + 1 < numOfElements; ++i) { ptrs[i].reset(); }
+	ASSERT_EQ(allocator.Size(), 1);
+	const auto freedMem(ResidentMem());
+	ASSERT_LT(freedMem - std::min(freedMem, startingMem), (allocatedMem - startingMem) / 4);
+
+	// The released buckets are grown back into
+	for (std::size_t i(0); i + 1 < numOfElements; ++i) {
+		ptrs[i] = allocator.Allocate();
+		ASSERT_NE(nullptr, ptrs[i]);
+		ptrs[i]->fill(static_cast<char>(i));
+	}
+	ASSERT_EQ(nullptr, allocator.Allocate());
+	ASSERT_EQ(allocator.Size(), numOfElements);
+	for (std::size_t i(0); i < numOfElements; ++i) {
+		ASSERT_EQ(ptrs[i]->back(), static_cast<char>(i));
+	}
+}
+
+TEST(EvictionMemTest, AnyBucketEviction_ReleasesHolePunchedMiddle)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	using Allocator = PageSizedAllocator<AnyBucketEviction, PoolId<1>>;
+	constexpr std::size_t numOfElements(64 * 32);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(numOfElements, std::back_inserter(ptrs)), numOfElements);
+	for (std::size_t i(0); i < numOfElements; ++i) { ptrs[i]->fill(static_cast<char>(i)); }
+
+	const auto allocatedMem(ResidentMem());
+	const auto *const bucket8(&*ptrs[64 * 8]);
+	const auto *const bucket9(&*ptrs[64 * 9]);
+	std::set<const std::array<char, 4'096> *> holes;
+	for (std::size_t i(64 * 24 + 1); i < 64 * 25; i += 2) { holes.insert(&*ptrs[i]); }
+
+	// Free buckets 8 to 23 and half of bucket 24. We only keep one spare bucket, the others are
+	// released even though the buckets above them are in use
+	for (std::size_t i(64 * 8); i < 64 * 24; ++i) { ptrs[i].reset(); }
+	for (std::size_t i(64 * 24 + 1); i < 64 * 25; i += 2) { ptrs[i].reset(); }
+	ASSERT_LE(ResidentMem() + 12 * PAGE_SIZED_BUCKET_BYTES, allocatedMem);
+	ASSERT_EQ(allocator.Size(), numOfElements - 64 * 16 - 32);
+
+	// The free lists are used up first, then we grow back into the lowest released bucket
+	std::vector<Allocator::PtrType> refilled;
+	ASSERT_EQ(allocator.AllocateN(64 + 32 + 64, std::back_inserter(refilled)), 64 + 32 + 64);
+	for (std::size_t i(0); i < 64; ++i) {
+		ASSERT_GE(&*refilled[i], bucket8);
+		ASSERT_LT(&*refilled[i], bucket8 + 64);
+	}
+	for (std::size_t i(64); i < 64 + 32; ++i) { ASSERT_EQ(holes.count(&*refilled[i]), 1); }
+	for (std::size_t i(0); i < 64; ++i) { ASSERT_EQ(&*refilled[64 + 32 + i], bucket9 + i); }
+	for (std::size_t i(0); i < refilled.size(); ++i) { refilled[i]->fill(static_cast<char>(i)); }
+	ASSERT_EQ(allocator.Size(), numOfElements - 64 * 14);
+
+	for (std::size_t i(0); i < numOfElements; ++i) {
+		if (nullptr != ptrs[i]) { ASSERT_EQ(ptrs[i]->back(), static_cast<char>(i)); }
+	}
+	for (std::size_t i(0); i < refilled.size(); ++i) {
+		ASSERT_EQ(refilled[i]->back(), static_cast<char>(i));
+	}
+}
+
+TEST(EvictionMemTest, WatermarkEviction_EvictsAboveHighDownToLow)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	using Allocator = PageSizedAllocator<WatermarkEviction<4, 1>>;
+	constexpr std::size_t numOfElements(64 * 32);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(numOfElements, std::back_inserter(ptrs)), numOfElements);
+	for (auto &ptr : ptrs) { ptr->fill(1); }
+
+	// Up to the high watermark nothing is evicted
+	const auto allocatedMem(ResidentMem());
+	for (std::size_t i(0); i < 64 * 4; ++i) { ptrs.pop_back(); }
+	ASSERT_GE(ResidentMem() + PAGE_SIZED_BUCKET_BYTES / 2, allocatedMem);
+
+	// One more takes us over it, so we evict until only one bucket or so is free
+	ptrs.pop_back();
+	ASSERT_LE(ResidentMem() + 3 * PAGE_SIZED_BUCKET_BYTES, allocatedMem);
+	ASSERT_GE(ResidentMem() + 5 * PAGE_SIZED_BUCKET_BYTES, allocatedMem);
+	ASSERT_EQ(allocator.Size(), numOfElements - 64 * 4 - 1);
+}
+
+TEST(EvictionMemTest, IdleEviction_EvictsOnlyAfterTheBucketIsIdle)
+{
+	if (!RESIDENT_MEM_IS_MEANINGFUL) { GTEST_SKIP() << "Sanitizers skew the resident set size"; }
+
+	using Allocator = PageSizedAllocator<IdleEviction<50>>;
+	constexpr std::size_t numOfElements(64 * 8);
+	Allocator allocator{numOfElements};
+	std::vector<Allocator::PtrType> ptrs;
+	ASSERT_EQ(allocator.AllocateN(numOfElements, std::back_inserter(ptrs)), numOfElements);
+	for (auto &ptr : ptrs) { ptr->fill(1); }
+
+	const auto allocatedMem(ResidentMem());
+	for (std::size_t i(0); i < 64 * 4; ++i) { ptrs.pop_back(); }
+	allocator.Maintain();
+	ASSERT_GE(ResidentMem() + PAGE_SIZED_BUCKET_BYTES / 2, allocatedMem);
+
+	// One bucket per idle period
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	allocator.Maintain();
+	ASSERT_LE(ResidentMem() + PAGE_SIZED_BUCKET_BYTES * 3 / 4, allocatedMem);
+	ASSERT_GE(ResidentMem() + PAGE_SIZED_BUCKET_BYTES * 3 / 2, allocatedMem);
+
+	for (std::size_t i(0); i < 3; ++i) {
+		allocator.Maintain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(60));
+		allocator.Maintain();
+	}
+	ASSERT_LE(ResidentMem() + PAGE_SIZED_BUCKET_BYTES * 7 / 2, allocatedMem);
+	ASSERT_EQ(allocator.Size(), numOfElements - 64 * 4);
+}
+
 std::size_t CurrentMem()
 {
 	struct sysinfo memInfo;
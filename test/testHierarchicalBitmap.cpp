@@ -0,0 +1,172 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testHierarchicalBitmap.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../HierarchicalBitmap.h"
+
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+TEST(HierarchicalBitmap, Empty_FindsNothing)
+{
+	ASSERT_EQ(HierarchicalBitmap<>{}.FindFirst(), HierarchicalBitmap<>::NONE);
+	ASSERT_EQ(HierarchicalBitmap<>{0}.FindFirst(), HierarchicalBitmap<>::NONE);
+	ASSERT_EQ(HierarchicalBitmap<>{100}.FindFirst(), HierarchicalBitmap<>::NONE);
+	ASSERT_EQ(HierarchicalBitmap<>{}.FindLast(), HierarchicalBitmap<>::NONE);
+	ASSERT_EQ(HierarchicalBitmap<>{100}.FindLast(), HierarchicalBitmap<>::NONE);
+}
+
+TEST(HierarchicalBitmap, FindsLowestSetBit)
+{
+	HierarchicalBitmap<> bitmap(100'000);
+
+	bitmap.Set(99'999);
+	ASSERT_EQ(bitmap.FindFirst(), 99'999);
+
+	bitmap.Set(4'097);
+	bitmap.Set(64);
+	ASSERT_EQ(bitmap.FindFirst(), 64);
+	ASSERT_TRUE(bitmap.Test(4'097));
+	ASSERT_FALSE(bitmap.Test(4'096));
+
+	bitmap.Clear(64);
+	ASSERT_EQ(bitmap.FindFirst(), 4'097);
+	bitmap.Clear(4'097);
+	ASSERT_EQ(bitmap.FindFirst(), 99'999);
+	bitmap.Clear(99'999);
+	ASSERT_EQ(bitmap.FindFirst(), HierarchicalBitmap<>::NONE);
+}
+
+TEST(HierarchicalBitmap, FindsHighestSetBit)
+{
+	HierarchicalBitmap<> bitmap(100'000);
+
+	bitmap.Set(0);
+	ASSERT_EQ(bitmap.FindLast(), 0);
+	bitmap.Set(4'097);
+	bitmap.Set(99'999);
+	ASSERT_EQ(bitmap.FindLast(), 99'999);
+
+	bitmap.Clear(99'999);
+	ASSERT_EQ(bitmap.FindLast(), 4'097);
+	bitmap.Clear(4'097);
+	ASSERT_EQ(bitmap.FindLast(), 0);
+}
+
+TEST(HierarchicalBitmap, SettingTwice_NeedsOneClear)
+{
+	HierarchicalBitmap<> bitmap(10);
+	bitmap.Set(3);
+	bitmap.Set(3);
+	bitmap.Clear(3);
+	ASSERT_EQ(bitmap.FindFirst(), HierarchicalBitmap<>::NONE);
+}
+
+TEST(HierarchicalBitmap, RandomSetsAndClears_MatchesSet)
+{
+	constexpr std::size_t numOfBits(300'000);
+	HierarchicalBitmap<> bitmap(numOfBits);
+	std::set<std::size_t> expected;
+
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<std::size_t> dis(0, numOfBits - 1);
+
+	for (std::size_t i(0); i < 100'000; ++i) {
+		const auto bit(dis(gen));
+		if (i % 3 == 0) {
+			bitmap.Clear(bit);
+			expected.erase(bit);
+		} else {
+			bitmap.Set(bit);
+			expected.insert(bit);
+		}
+		ASSERT_EQ(bitmap.FindFirst(), expected.empty() ? HierarchicalBitmap<>::NONE
+													   : *expected.begin());
+		ASSERT_EQ(bitmap.FindLast(), expected.empty() ? HierarchicalBitmap<>::NONE
+													  : *expected.rbegin());
+	}
+}
+
+TEST(HierarchicalBitmap, FindNext_WalksSetBitsInOrder)
+{
+	HierarchicalBitmap<> bitmap(300'000);
+	ASSERT_EQ(bitmap.FindNext(0), HierarchicalBitmap<>::NONE);
+
+	for (const std::size_t bit : {0, 63, 64, 4'095, 4'096, 262'144, 299'999}) { bitmap.Set(bit); }
+	ASSERT_EQ(bitmap.FindNext(0), 0);
+	ASSERT_EQ(bitmap.FindNext(1), 63);
+	ASSERT_EQ(bitmap.FindNext(64), 64);
+	ASSERT_EQ(bitmap.FindNext(65), 4'095);
+	ASSERT_EQ(bitmap.FindNext(4'097), 262'144);
+	ASSERT_EQ(bitmap.FindNext(262'145), 299'999);
+	ASSERT_EQ(bitmap.FindNext(300'000), HierarchicalBitmap<>::NONE);
+	bitmap.Clear(299'999);
+	ASSERT_EQ(bitmap.FindNext(262'145), HierarchicalBitmap<>::NONE);
+}
+
+TEST(HierarchicalBitmap, FindNext_MatchesSet)
+{
+	constexpr std::size_t numOfBits(300'000);
+	HierarchicalBitmap<> bitmap(numOfBits);
+	std::set<std::size_t> expected;
+
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<std::size_t> dis(0, numOfBits - 1);
+	for (std::size_t i(0); i < 1'000; ++i) {
+		const auto bit(dis(gen));
+		bitmap.Set(bit);
+		expected.insert(bit);
+	}
+
+	std::vector<std::size_t> found;
+	for (auto bit(bitmap.FindNext(0)); bit != HierarchicalBitmap<>::NONE;
+		 bit = bitmap.FindNext(bit + 1)) {
+		found.push_back(bit);
+	}
+	ASSERT_EQ(found, std::vector<std::size_t>(expected.begin(), expected.end()));
+}
+
+TEST(ConcurrentHierarchicalBitmap, ConcurrentSetsAndClears_DontLoseBits)
+{
+	// Each thread owns every 4th bit, so at the end we know exactly what should be set
+	constexpr std::size_t numThreads(4);
+	constexpr std::size_t numOfBits(64 * 64 * 2);
+	HierarchicalBitmap<true> bitmap(numOfBits);
+
+	std::vector<std::thread> threads;
+	for (std::size_t t(0); t < numThreads; ++t) {
+		threads.emplace_back([&, t]() {
+			std::mt19937 gen(t);
+			std::uniform_int_distribution<std::size_t> dis(0, numOfBits / numThreads - 1);
+			for (std::size_t i(0); i < 100'000; ++i) {
+				const auto bit(dis(gen) * numThreads + t);
+				if (i % 2 == 0) {
+					bitmap.Set(bit);
+				} else {
+					bitmap.Clear(bit);
+				}
+			}
+			// Leave just our last bit set
+			for (std::size_t bit(t); bit < numOfBits; bit += numThreads) { bitmap.Clear(bit); }
+			bitmap.Set(numOfBits - numThreads + t);
+		});
+	}
+	for (auto &thread : threads) { thread.join(); }
+
+	for (std::size_t t(0); t < numThreads; ++t) {
+		ASSERT_EQ(bitmap.FindFirst(), numOfBits - numThreads + t);
+		bitmap.Clear(numOfBits - numThreads + t);
+	}
+	ASSERT_EQ(bitmap.FindFirst(), HierarchicalBitmap<true>::NONE);
+}
+
+}// namespace hgalloc
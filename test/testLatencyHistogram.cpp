@@ -0,0 +1,76 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testLatencyHistogram.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+TEST(LatencyHistogram, Empty_ReturnsZero)
+{
+	LatencyHistogram histogram;
+	ASSERT_EQ(histogram.Count(), 0);
+	ASSERT_EQ(histogram.Percentile(99), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact)
+{
+	LatencyHistogram histogram;
+	for (std::uint64_t i(1); i <= 100; ++i) { histogram.Record(i); }
+
+	ASSERT_EQ(histogram.Count(), 100);
+	ASSERT_EQ(histogram.Max(), 100);
+	ASSERT_EQ(histogram.Percentile(50), 50);
+	ASSERT_EQ(histogram.Percentile(99), 99);
+	ASSERT_EQ(histogram.Percentile(100), 100);
+}
+
+TEST(LatencyHistogram, EveryValueIsWithinItsCounter)
+{
+	std::mt19937_64 gen(100);
+	for (std::size_t i(0); i < 100'000; ++i) {
+		const std::uint64_t value(gen() >> (gen() % 64));
+		const auto index(LatencyHistogram::IndexOf(value));
+
+		ASSERT_LE(value, LatencyHistogram::HighestValueAt(index));
+		if (index > 0) { ASSERT_GT(value, LatencyHistogram::HighestValueAt(index - 1)); }
+		// Within 1/64th
+		ASSERT_LE(LatencyHistogram::HighestValueAt(index) - value, value / 64);
+	}
+	ASSERT_EQ(LatencyHistogram::HighestValueAt(LatencyHistogram::IndexOf(~std::uint64_t{0})),
+			  ~std::uint64_t{0});
+}
+
+TEST(LatencyHistogram, Percentiles_MatchSortedValues)
+{
+	std::mt19937_64 gen(100);
+	std::exponential_distribution<> dis(0.01);
+
+	LatencyHistogram histogram;
+	LatencyHistogram firstHalf;
+	std::vector<std::uint64_t> values;
+	for (std::size_t i(0); i < 100'000; ++i) {
+		values.push_back(static_cast<std::uint64_t>(dis(gen)));
+		(i % 2 == 0 ? histogram : firstHalf).Record(values.back());
+	}
+	histogram.Merge(firstHalf);
+	std::sort(values.begin(), values.end());
+
+	for (const double percentile : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+		const auto expected(values[static_cast<std::size_t>(percentile / 100.0 * 100'000) - 1]);
+		ASSERT_GE(histogram.Percentile(percentile), expected);
+		ASSERT_LE(histogram.Percentile(percentile), expected + expected / 64);
+	}
+	ASSERT_EQ(histogram.Percentile(100), values.back());
+}
+
+}// namespace hgalloc
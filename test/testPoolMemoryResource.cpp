@@ -0,0 +1,148 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testPoolMemoryResource.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../PoolMemoryResource.h"
+
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+// Counts what reaches it, so we can see what the pool passed on
+class CountingResource : public std::pmr::memory_resource {
+public:
+	std::size_t allocations_{0};
+	std::size_t deallocations_{0};
+
+private:
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override
+	{
+		++allocations_;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	auto do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) -> void override
+	{
+		++deallocations_;
+		std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+	}
+
+	[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &rhs) const noexcept
+			-> bool override
+	{
+		return this == &rhs;
+	}
+};
+
+struct PoolMemoryResourceTest : ::testing::Test {
+	static constexpr std::size_t maxBlocks{1'000};
+
+	CountingResource upstream;
+	PoolMemoryResource<64, 128> resource{maxBlocks, &upstream};
+};
+
+TEST_F(PoolMemoryResourceTest, ListNodesComeFromThePool)
+{
+	{
+		std::pmr::list<int> list{&resource};
+		for (int i(0); i < 500; ++i) { list.push_back(i); }
+
+		ASSERT_EQ(resource.Pool().Size(), 500);
+		int expected(0);
+		for (const auto value : list) { ASSERT_EQ(value, expected++); }
+	}
+	ASSERT_EQ(resource.Pool().Size(), 0);
+	ASSERT_EQ(upstream.allocations_, 0);
+}
+
+TEST_F(PoolMemoryResourceTest, MapSurvivesRandomInsertsAndErases)
+{
+	std::pmr::map<int, int> map{&resource};
+	std::map<int, int> expected;
+	for (int i(0); i < 2'000; ++i) {
+		const int key((i * 7'919) % 601);
+		if (i % 3 == 0) {
+			map.erase(key);
+			expected.erase(key);
+		} else {
+			map[key] = i;
+			expected[key] = i;
+		}
+	}
+
+	ASSERT_EQ(resource.Pool().Size(), expected.size());
+	ASSERT_TRUE(std::equal(map.begin(), map.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(PoolMemoryResourceTest, BigAndOveralignedAllocationsGoUpstream)
+{
+	void *big(resource.allocate(65, 8));
+	void *overaligned(resource.allocate(64, 2 * alignof(std::max_align_t)));
+	void *small(resource.allocate(64, 8));
+
+	ASSERT_EQ(upstream.allocations_, 2);
+	ASSERT_EQ(resource.Pool().Size(), 1);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(overaligned) % (2 * alignof(std::max_align_t)), 0);
+
+	resource.deallocate(big, 65, 8);
+	resource.deallocate(overaligned, 64, 2 * alignof(std::max_align_t));
+	resource.deallocate(small, 64, 8);
+
+	ASSERT_EQ(upstream.deallocations_, 2);
+	ASSERT_EQ(resource.Pool().Size(), 0);
+}
+
+TEST_F(PoolMemoryResourceTest, FullPoolFallsBackToUpstream)
+{
+	std::vector<void *> blocks;
+	for (std::size_t i(0); i < maxBlocks + 10; ++i) { blocks.push_back(resource.allocate(32)); }
+
+	ASSERT_EQ(resource.Pool().Size(), maxBlocks);
+	ASSERT_EQ(upstream.allocations_, 10);
+
+	// Freed pool blocks are reused before upstream is asked again
+	resource.deallocate(blocks.front(), 32);
+	blocks.front() = resource.allocate(32);
+	ASSERT_EQ(upstream.allocations_, 10);
+
+	for (auto *block : blocks) { resource.deallocate(block, 32); }
+	ASSERT_EQ(upstream.deallocations_, 10);
+	ASSERT_EQ(resource.Pool().Size(), 0);
+}
+
+TEST_F(PoolMemoryResourceTest, BlocksAreAlignedAndDistinct)
+{
+	std::vector<unsigned char *> blocks;
+	for (std::size_t i(0); i < 300; ++i) {
+		auto *block(static_cast<unsigned char *>(resource.allocate(64)));
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t), 0);
+		std::fill(block, block + 64, static_cast<unsigned char>(i));
+		blocks.push_back(block);
+	}
+	for (std::size_t i(0); i < blocks.size(); ++i) {
+		ASSERT_EQ(blocks[i][63], static_cast<unsigned char>(i));
+		resource.deallocate(blocks[i], 64);
+	}
+}
+
+// The reverse lookup has to cope with the gaps between huge page aligned buckets
+TEST(PoolMemoryResource, WorksWithHugePageBuckets)
+{
+	PoolMemoryResource<48, 1'024, TransparentHugePages> resource{10'000};
+	std::pmr::list<int> list{&resource};
+	for (int i(0); i < 5'000; ++i) { list.push_back(i); }
+	ASSERT_EQ(resource.Pool().Size(), 5'000);
+
+	list.clear();
+	ASSERT_EQ(resource.Pool().Size(), 0);
+}
+
+}// namespace hgalloc
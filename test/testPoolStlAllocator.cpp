@@ -0,0 +1,197 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testPoolStlAllocator.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../PoolStlAllocator.h"
+
+#include <forward_list>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+template<typename T>
+using Alloc = PoolStlAllocator<T, 10'000, 256>;
+
+// The pool a container's nodes come from, which is the allocator rebound to the node type, so we
+// find it through an allocation of the same size and alignment
+template<typename Node>
+auto PoolSize() -> std::size_t
+{
+	return Alloc<Node>::NodePool::Instance().Size();
+}
+
+TEST(PoolStlAllocator, MapNodesComeFromThePool)
+{
+	using Map = std::map<int, std::string, std::less<>, Alloc<std::pair<const int, std::string>>>;
+	using Node = std::_Rb_tree_node<std::pair<const int, std::string>>;
+	{
+		Map map;
+		for (int i(0); i < 1'000; ++i) { map.emplace(i, std::to_string(i)); }
+		for (int i(0); i < 1'000; i += 2) { map.erase(i); }
+
+		ASSERT_EQ(PoolSize<Node>(), 500);
+		int expected(1);
+		for (const auto &[key, value] : map) {
+			ASSERT_EQ(key, expected);
+			ASSERT_EQ(value, std::to_string(expected));
+			expected += 2;
+		}
+	}
+	ASSERT_EQ(PoolSize<Node>(), 0);
+}
+
+TEST(PoolStlAllocator, SetAndListWork)
+{
+	std::set<std::uint64_t, std::less<>, Alloc<std::uint64_t>> set;
+	std::list<std::uint64_t, Alloc<std::uint64_t>> list;
+	for (std::uint64_t i(0); i < 1'000; ++i) {
+		set.insert(i * 3 % 1'000);
+		list.push_front(i);
+	}
+	ASSERT_EQ(set.size(), 1'000);
+	ASSERT_EQ(*set.begin(), 0);
+	ASSERT_EQ(*set.rbegin(), 999);
+	ASSERT_EQ(list.front(), 999);
+	list.sort();
+	ASSERT_TRUE(std::equal(set.begin(), set.end(), list.begin(), list.end()));
+}
+
+// The bucket array is allocated as an array, so comes from std::allocator
+TEST(PoolStlAllocator, UnorderedMapWorks)
+{
+	using Value = std::pair<const std::uint64_t, std::uint64_t>;
+	std::unordered_map<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>,
+					   std::equal_to<>, Alloc<Value>>
+			map;
+	for (std::uint64_t i(0); i < 5'000; ++i) { map[i] = i * 2; }
+	for (std::uint64_t i(0); i < 5'000; i += 5) { map.erase(i); }
+
+	ASSERT_EQ(map.size(), 4'000);
+	for (std::uint64_t i(1); i < 5'000; i += 5) { ASSERT_EQ(map.at(i), i * 2); }
+}
+
+TEST(PoolStlAllocator, ArraysAndFullPoolsFallBackToStdAllocator)
+{
+	using Small = PoolStlAllocator<std::uint64_t, 100, 64>;
+	Small allocator;
+	auto &pool(Small::NodePool::Instance());
+
+	auto *array(allocator.allocate(10));
+	ASSERT_FALSE(Small::NodePool::Pool::Contains(array));
+
+	std::vector<std::uint64_t *> nodes;
+	for (std::size_t i(0); i < 110; ++i) {
+		nodes.push_back(allocator.allocate(1));
+		*nodes.back() = i;
+	}
+	ASSERT_EQ(pool.Size(), 100);
+	ASSERT_TRUE(Small::NodePool::Pool::Contains(nodes.front()));
+	ASSERT_FALSE(Small::NodePool::Pool::Contains(nodes.back()));
+
+	for (std::size_t i(0); i < nodes.size(); ++i) {
+		ASSERT_EQ(*nodes[i], i);
+		allocator.deallocate(nodes[i], 1);
+	}
+	allocator.deallocate(array, 10);
+	ASSERT_EQ(pool.Size(), 0);
+}
+
+TEST(PoolStlAllocator, RebindsAndComparesEqual)
+{
+	Alloc<int> a;
+	const Alloc<double> b(a);
+	ASSERT_TRUE(a == b);
+	static_assert(std::is_same_v<std::allocator_traits<Alloc<int>>::rebind_alloc<double>,
+								 Alloc<double>>);
+}
+
+// Separate maps on separate threads still share the node pool
+TEST(PoolStlAllocator, MapsOnTwoThreadsShareThePool)
+{
+	using Map = std::map<std::uint64_t, std::uint64_t, std::less<>,
+						 Alloc<std::pair<const std::uint64_t, std::uint64_t>>>;
+	const auto churn([](std::uint64_t offset) {
+		for (std::uint64_t runs(0); runs < 20; ++runs) {
+			Map map;
+			for (std::uint64_t i(0); i < 2'000; ++i) { map.emplace(i, i + offset); }
+			for (std::uint64_t i(0); i < 2'000; i += 2) { map.erase(i); }
+			for (std::uint64_t i(1); i < 2'000; i += 2) { EXPECT_EQ(map.at(i), i + offset); }
+		}
+	});
+	{
+		const std::jthread first(churn, 0);
+		const std::jthread second(churn, 1'000'000);
+	}
+	using Node = std::_Rb_tree_node<std::pair<const std::uint64_t, std::uint64_t>>;
+	ASSERT_EQ(PoolSize<Node>(), 0);
+}
+
+template<typename T>
+using CompactAlloc = CompactPoolStlAllocator<T, 10'000, 256>;
+
+TEST(CompactPoolStlAllocator, PointersAreFourBytes)
+{
+	using Traits = std::allocator_traits<CompactAlloc<std::uint64_t>>;
+	static_assert(sizeof(Traits::pointer) == 4);
+	static_assert(sizeof(Traits::void_pointer) == 4);
+	static_assert(std::is_same_v<Traits::rebind_traits<int>::pointer, CompactAlloc<int>::pointer>);
+}
+
+TEST(CompactPoolStlAllocator, PointerRoundTrips)
+{
+	using Traits = std::allocator_traits<CompactAlloc<std::uint64_t>>;
+	CompactAlloc<std::uint64_t> allocator;
+
+	Traits::pointer ptr(Traits::allocate(allocator, 1));
+	ASSERT_TRUE(ptr);
+	ASSERT_FALSE(ptr == nullptr);
+	*ptr = 42;
+
+	const Traits::const_pointer constPtr(ptr);
+	const Traits::void_pointer voidPtr(ptr);
+	const auto back(static_cast<Traits::pointer>(voidPtr));
+	ASSERT_EQ(back, ptr);
+	ASSERT_EQ(*constPtr, 42);
+	ASSERT_EQ(std::pointer_traits<Traits::pointer>::pointer_to(*ptr), ptr);
+	ASSERT_EQ(std::to_address(ptr), ptr.get());
+
+	Traits::deallocate(allocator, ptr, 1);
+	ASSERT_EQ(Traits::pointer{}, nullptr);
+}
+
+TEST(CompactPoolStlAllocator, ForwardListWorks)
+{
+	{
+		std::forward_list<std::uint64_t, CompactAlloc<std::uint64_t>> list;
+		for (std::uint64_t i(0); i < 1'000; ++i) { list.push_front(i); }
+		list.remove_if([](std::uint64_t i) { return i % 2 == 0; });
+		list.reverse();
+
+		std::uint64_t expected(1);
+		for (const auto value : list) {
+			ASSERT_EQ(value, expected);
+			expected += 2;
+		}
+		ASSERT_EQ(expected, 1'001);
+	}
+	ASSERT_EQ(CompactAlloc<std::_Fwd_list_node<std::uint64_t>>::NodePool::Instance().Size(), 0);
+}
+
+TEST(CompactPoolStlAllocator, ArraysThrow)
+{
+	CompactAlloc<std::uint64_t> allocator;
+	ASSERT_THROW((void)allocator.allocate(2), std::bad_alloc);
+}
+
+}// namespace hgalloc
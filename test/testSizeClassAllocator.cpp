@@ -0,0 +1,145 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testSizeClassAllocator.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../SizeClassAllocator.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+using Allocator = SizeClassAllocator<1 << 14>;
+
+TEST(SizeClassAllocatorClasses, RoundUpToPowersOfTwo)
+{
+	static_assert(Allocator::NUM_OF_CLASSES == 9);
+	static_assert(Allocator::ClassOf(0) == 0);
+	static_assert(Allocator::ClassOf(1) == 0);
+	static_assert(Allocator::ClassOf(16) == 0);
+	static_assert(Allocator::ClassOf(17) == 1);
+	static_assert(Allocator::ClassOf(32) == 1);
+	static_assert(Allocator::ClassOf(33) == 2);
+	static_assert(Allocator::ClassOf(4'095) == 8);
+	static_assert(Allocator::ClassOf(4'096) == 8);
+	for (std::size_t bytes(1); bytes <= Allocator::MAX_CLASS_SIZE; ++bytes) {
+		const auto sizeClass(Allocator::ClassOf(bytes));
+		ASSERT_GE(Allocator::ClassSize(sizeClass), bytes);
+		if (sizeClass > 0) { ASSERT_LT(Allocator::ClassSize(sizeClass - 1), bytes); }
+	}
+}
+
+struct SizeClassAllocatorTest : ::testing::Test {
+	static constexpr std::size_t maxBytesPerClass{1 << 24};
+	Allocator allocator{maxBytesPerClass};
+};
+
+TEST_F(SizeClassAllocatorTest, HandlesAreFourBytes)
+{
+	static_assert(sizeof(Allocator::PtrType) == 4);
+}
+
+TEST_F(SizeClassAllocatorTest, EachSizeGetsItsClass)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t bytes : {1, 16, 17, 100, 1'000, 4'096}) {
+		ptrs.push_back(allocator.Allocate(bytes));
+		ASSERT_FALSE(nullptr == ptrs.back());
+		ASSERT_EQ(ptrs.back().Capacity(), Allocator::ClassSize(Allocator::ClassOf(bytes)));
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptrs.back().get()) % 16, 0);
+	}
+	ASSERT_EQ(allocator.Size(0), 2);
+	ASSERT_EQ(allocator.Size(1), 1);
+	ASSERT_EQ(allocator.BytesInUse(), 16 + 16 + 32 + 128 + 1'024 + 4'096);
+
+	ptrs.clear();
+	ASSERT_EQ(allocator.BytesInUse(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, TooBigIsNull)
+{
+	auto ptr(allocator.Allocate(Allocator::MAX_CLASS_SIZE + 1));
+	ASSERT_TRUE(nullptr == ptr);
+	ASSERT_EQ(ptr.get(), nullptr);
+	ASSERT_EQ(ptr.Capacity(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, FullClassIsNullOthersStillWork)
+{
+	std::vector<Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < maxBytesPerClass / 4'096; ++i) {
+		ptrs.push_back(allocator.Allocate(4'096));
+		ASSERT_FALSE(nullptr == ptrs.back());
+	}
+	ASSERT_TRUE(nullptr == allocator.Allocate(3'000));
+	ASSERT_FALSE(nullptr == allocator.Allocate(2'000));
+
+	ptrs.pop_back();
+	ASSERT_FALSE(nullptr == allocator.Allocate(3'000));
+}
+
+// Every allocation keeps its own bytes whatever else is allocated and freed around it
+TEST_F(SizeClassAllocatorTest, RandomSizesKeepTheirContents)
+{
+	struct Allocation {
+		Allocator::PtrType ptr;
+		std::size_t bytes;
+		unsigned char fill;
+	};
+	std::vector<Allocation> allocations;
+	std::mt19937 gen(5);
+	std::uniform_int_distribution<std::size_t> sizes(1, Allocator::MAX_CLASS_SIZE);
+
+	for (std::size_t i(0); i < 5'000; ++i) {
+		if (!allocations.empty() && gen() % 3 == 0) {
+			const std::size_t victim(gen() % allocations.size());
+			std::swap(allocations[victim], allocations.back());
+			allocations.pop_back();
+			continue;
+		}
+		const auto bytes(sizes(gen));
+		const auto fill(static_cast<unsigned char>(i));
+		auto ptr(allocator.Allocate(bytes));
+		ASSERT_FALSE(nullptr == ptr);
+		std::memset(ptr.get(), fill, bytes);
+		allocations.push_back({std::move(ptr), bytes, fill});
+	}
+
+	for (auto &allocation : allocations) {
+		const auto *bytes(static_cast<const unsigned char *>(allocation.ptr.get()));
+		ASSERT_TRUE(std::all_of(bytes, bytes + allocation.bytes,
+								[&](unsigned char b) { return b == allocation.fill; }));
+	}
+}
+
+TEST_F(SizeClassAllocatorTest, ReleaseAndMove)
+{
+	auto a(allocator.Allocate(64));
+	auto b(std::move(a));
+	ASSERT_TRUE(nullptr == a);
+	ASSERT_EQ(allocator.Size(Allocator::ClassOf(64)), 1);
+
+	const FourBytePtr raw(b.release());
+	ASSERT_EQ(allocator.Size(Allocator::ClassOf(64)), 1);
+	Allocator::PtrType{raw};
+	ASSERT_EQ(allocator.Size(Allocator::ClassOf(64)), 0);
+}
+
+// The biggest class has one element per bucket
+TEST(SizeClassAllocator, SmallestBuckets)
+{
+	SizeClassAllocator<Allocator::MAX_CLASS_SIZE, PoolId<1>> allocator{1 << 16};
+	std::vector<SizeClassAllocator<Allocator::MAX_CLASS_SIZE, PoolId<1>>::PtrType> ptrs;
+	for (std::size_t i(0); i < 16; ++i) { ptrs.push_back(allocator.Allocate(4'000)); }
+	ASSERT_EQ(allocator.Size(8), 16);
+	ptrs.clear();
+	ASSERT_EQ(allocator.Size(8), 0);
+}
+
+}// namespace hgalloc
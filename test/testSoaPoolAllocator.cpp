@@ -0,0 +1,138 @@
+/*--------------------------------------------------------------------------------------------------
+ *
+ * testSoaPoolAllocator.cpp
+ *
+ *--------------------------------------------------------------------------------------------------
+ */
+
+#include "../SoaPoolAllocator.h"
+
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hgalloc {
+
+enum Field { PRICE, SIZE, VENUE };
+
+template<typename Storage>
+struct SoaPoolAllocatorTest : ::testing::Test {
+	using Allocator = SoaPoolAllocator<std::tuple<double, std::uint64_t, std::uint8_t>, 8, Storage>;
+	static constexpr std::size_t maxElements{64};
+	Allocator allocator{maxElements};
+};
+
+using Storages = ::testing::Types<HeapBuckets, ReservedAddressSpace>;
+TYPED_TEST_SUITE(SoaPoolAllocatorTest, Storages);
+
+TYPED_TEST(SoaPoolAllocatorTest, HandlesAreFourBytes)
+{
+	static_assert(sizeof(typename TestFixture::Allocator::PtrType) == 4);
+}
+
+TYPED_TEST(SoaPoolAllocatorTest, AllocateSetsEveryColumn)
+{
+	using Allocator = typename TestFixture::Allocator;
+	auto ptr(this->allocator.Allocate(1.5, 100, 7));
+	ASSERT_NE(nullptr, ptr);
+	ASSERT_EQ(Allocator::template Get<PRICE>(ptr), 1.5);
+	ASSERT_EQ(Allocator::template Get<SIZE>(ptr), 100);
+	ASSERT_EQ(Allocator::template Get<VENUE>(ptr), 7);
+
+	Allocator::template Get<SIZE>(ptr) = 200;
+	ASSERT_EQ(Allocator::template Get<SIZE>(ptr.Index()), 200);
+	ASSERT_EQ(Allocator::template Get<PRICE>(ptr), 1.5);
+	ASSERT_EQ(this->allocator.Size(), 1);
+}
+
+TYPED_TEST(SoaPoolAllocatorTest, ColumnsAreContiguous)
+{
+	using Allocator = typename TestFixture::Allocator;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 8; ++i) {
+		ptrs.push_back(this->allocator.Allocate(static_cast<double>(i), i, 0));
+	}
+
+	const auto prices(Allocator::template Column<PRICE>(0));
+	for (std::size_t i(0); i < ptrs.size(); ++i) {
+		ASSERT_EQ(&prices[ptrs[i].Index()], &Allocator::template Get<PRICE>(ptrs[i]));
+		ASSERT_EQ(prices[ptrs[i].Index()], static_cast<double>(i));
+	}
+}
+
+TYPED_TEST(SoaPoolAllocatorTest, ScanningColumns_SeesLiveRows)
+{
+	using Allocator = typename TestFixture::Allocator;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < 20; ++i) { ptrs.push_back(this->allocator.Allocate(1.0, i, 1)); }
+
+	// Rows that were never handed out are value initialised, so contribute nothing
+	std::uint64_t totalSize(0);
+	std::size_t venues(0);
+	for (std::size_t bucketNum(0); bucketNum < Allocator::NumOfBuckets(); ++bucketNum) {
+		if (!Allocator::IsBucketCreated(bucketNum)) { continue; }
+		const auto sizes(Allocator::template Column<SIZE>(bucketNum));
+		const auto venueColumn(Allocator::template Column<VENUE>(bucketNum));
+		totalSize = std::accumulate(sizes.begin(), sizes.end(), totalSize);
+		venues = std::accumulate(venueColumn.begin(), venueColumn.end(), venues);
+	}
+	ASSERT_EQ(totalSize, 19 * 20 / 2);
+	ASSERT_EQ(venues, 20);
+}
+
+TYPED_TEST(SoaPoolAllocatorTest, GrowsAndShrinksByBucket)
+{
+	using Allocator = typename TestFixture::Allocator;
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < TestFixture::maxElements; ++i) {
+		ptrs.push_back(this->allocator.Allocate(0.0, i, 0));
+		ASSERT_NE(nullptr, ptrs.back());
+	}
+	ASSERT_EQ(nullptr, this->allocator.Allocate(0.0, 0, 0));
+	for (std::size_t bucketNum(0); bucketNum < Allocator::NumOfBuckets(); ++bucketNum) {
+		ASSERT_TRUE(Allocator::IsBucketCreated(bucketNum));
+	}
+
+	ptrs.clear();
+	ASSERT_EQ(this->allocator.Size(), 0);
+	ASSERT_FALSE(Allocator::IsBucketCreated(Allocator::NumOfBuckets() - 1));
+}
+
+TYPED_TEST(SoaPoolAllocatorTest, RandomFreesAndRefills_ReturnsCorrectValues)
+{
+	using Allocator = typename TestFixture::Allocator;
+	std::mt19937 gen(100);
+	std::uniform_int_distribution<> dis(0, 3);
+
+	std::vector<typename Allocator::PtrType> ptrs;
+	for (std::size_t i(0); i < TestFixture::maxElements; ++i) {
+		ptrs.push_back(Allocator::PtrType::CreateNullPtr());
+	}
+	std::vector<std::uint64_t> values(ptrs.size());
+	for (std::size_t runs(0); runs < 20; ++runs) {
+		for (std::size_t i(0); i < ptrs.size(); ++i) {
+			if (nullptr == ptrs[i]) {
+				values[i] = runs * 1000 + i;
+				ptrs[i] = this->allocator.Allocate(static_cast<double>(values[i]), values[i],
+												   static_cast<std::uint8_t>(values[i]));
+				ASSERT_NE(nullptr, ptrs[i]);
+			}
+		}
+
+		for (auto &ptr : ptrs) {
+			if (dis(gen) != 0) { ptr.reset(); }
+		}
+		for (std::size_t i(0); i < ptrs.size(); ++i) {
+			if (nullptr == ptrs[i]) { continue; }
+			ASSERT_EQ(Allocator::template Get<PRICE>(ptrs[i]), static_cast<double>(values[i]));
+			ASSERT_EQ(Allocator::template Get<SIZE>(ptrs[i]), values[i]);
+			ASSERT_EQ(Allocator::template Get<VENUE>(ptrs[i]),
+					  static_cast<std::uint8_t>(values[i]));
+		}
+	}
+}
+
+}// namespace hgalloc